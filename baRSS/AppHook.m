@@ -77,6 +77,9 @@
 		if (ver <= 10505) { // v1.5.5
 			[self migrate_v1_6_0];
 		}
+		if (ver <= 10602) { // v1.6.2
+			[self migrate_v1_7_0];
+		}
 	}
 	[StoreCoordinator setOption:@"app-version" value:curVersion];
 }
@@ -101,6 +104,14 @@
 	UserPrefsSet(@"shortArticleNamesLimit", nil);
 }
 
+- (void)migrate_v1_7_0 {
+	NSLog(@"Migrating to v1.7.0");
+	// initialize stored article counts (new attributes in DBv2)
+	[StoreCoordinator restoreFeedCounts];
+	// initialize nested intervals (new attributes in DBv2)
+	[StoreCoordinator restoreFeedIndexPaths];
+}
+
 
 #pragma mark - App Preferences
 
@@ -139,6 +150,9 @@
 				if ([error inCaseLog:"Couldn't read NSPersistentContainer"])
 					abort();
 			}];
+			// merge changes saved by background contexts (see StoreCoordinator createBackgroundContext)
+			_persistentContainer.viewContext.automaticallyMergesChangesFromParent = YES;
+			_persistentContainer.viewContext.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
 		}
 	}
 	return _persistentContainer;
@@ -64,6 +64,12 @@ static NSNotificationName const kNotificationScheduleTimerChanged = @"baRSS-noti
  Called whenever a new feed group was created in @c autoDownloadAndParseURL:
  */
 static NSNotificationName const kNotificationFeedGroupInserted = @"baRSS-notification-feed-inserted";
+/**
+ @c notification.object is either @c nil or @c NSDictionary with old @c indexPath as key and new @c indexPath as value.
+ Value is @c NSNull if the item was deleted. Called whenever items are moved or deleted in preferences.
+ @c nil if the tree structure changed otherwise (e.g., insert or undo) and must be reloaded from core data.
+ */
+static NSNotificationName const kNotificationFeedTreeChanged = @"baRSS-notification-feed-tree-changed";
 /**
  @c notification.object is @c NSManagedObjectID of type @c Feed.
  Called whenever download of a feed finished and articles were modified (not if statusCode 304).
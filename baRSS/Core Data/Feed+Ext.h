@@ -4,6 +4,15 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Number of affected articles after merging remote articles into stored articles.
+typedef struct {
+	NSUInteger inserted, updated, deleted;
+	/// Subset of @c updated articles with matching content digest (no HTML conversion needed).
+	NSUInteger unchanged;
+	/// Relative unread count change (inserted minus deleted unread articles).
+	NSInteger unreadDiff;
+} ArticleReconcileCount;
+
 @interface Feed (Ext)
 @property (readonly) BOOL hasIcon;
 @property (nonnull, readonly) NSImage* iconImage16;
@@ -11,14 +20,20 @@ NS_ASSUME_NONNULL_BEGIN
 // Generator methods / Feed update
 + (instancetype)newFeedAndMetaInContext:(NSManagedObjectContext*)context;
 - (NSString*)notificationID;
-- (void)updateWithRSS:(RSParsedFeed*)obj postUnreadCountChange:(BOOL)flag;
+- (ArticleReconcileCount)updateWithRSS:(RSParsedFeed*)obj postUnreadCountChange:(BOOL)flag;
 - (NSMenuItem*)newMenuItem;
 // Getter & Setter
 - (void)calculateAndSetIndexPathString;
 - (void)setNewIcon:(NSURL*)location;
 // Article properties
 - (nullable NSArray<FeedArticle*>*)sortedArticles;
+- (NSArray<NSDate*>*)publishedDates;
 - (NSUInteger)countUnread;
+- (void)addUnreadCount:(NSInteger)diff;
+- (void)setUnreadCount:(int32_t)unread total:(int32_t)total;
+#ifdef DEBUG
++ (void)benchmarkReconcile;
+#endif
 @end
 
 NS_ASSUME_NONNULL_END
@@ -7,7 +7,9 @@
 #import "FeedArticle+Ext.h"
 #import "StoreCoordinator.h"
 #import "NotifyEndpoint.h"
+#import "FaviconDownload.h"
 #import "NSURL+Ext.h"
+#import "NSFetchRequest+Ext.h"
 
 @implementation Feed (Ext)
 
@@ -23,11 +25,13 @@
 	return self.objectID.URIRepresentation.absoluteString;
 }
 
-/// Call @c indexPathString on @c .group and update @c .indexPath if current value is different.
+/// Call @c indexPathString on @c .group and update @c .indexPath if current value is different. Same for @c .treeIndex .
 - (void)calculateAndSetIndexPathString {
 	NSString *pthStr = [self.group indexPathString];
 	if (![self.indexPath isEqualToString:pthStr])
 		self.indexPath = pthStr;
+	if (self.treeIndex != self.group.treeLower)
+		self.treeIndex = self.group.treeLower;
 }
 
 /// @return Fully initialized @c NSMenuItem with @c title, @c tooltip, @c image, and @c action.
@@ -41,7 +45,7 @@
 	//  2. hover over another feed with tooltip
 	//  3. go back to previous feed.
 //	item.toolTip = self.subtitle;
-	item.enabled = (self.articles.count > 0);
+	item.enabled = (self.totalCount > 0);
 	item.image = self.iconImage16;
 	item.representedObject = self.indexPath;
 	item.target = [self class];
@@ -63,77 +67,143 @@
 /**
  Replace feed title, subtitle and link (if changed). Also adds new articles and removes old ones.
  */
-- (void)updateWithRSS:(RSParsedFeed*)obj postUnreadCountChange:(BOOL)flag {
+- (ArticleReconcileCount)updateWithRSS:(RSParsedFeed*)obj postUnreadCountChange:(BOOL)flag {
 	if (![self.title isEqualToString:obj.title])       self.title = obj.title;
 	if (![self.subtitle isEqualToString:obj.subtitle]) self.subtitle = obj.subtitle;
 	if (![self.link isEqualToString:obj.link])         self.link = obj.link;
 	
 	// Add and remove articles
-	NSMutableSet<FeedArticle*> *localSet = [self.articles mutableCopy];
-	NSInteger diff = 0;
-	diff -= [self deleteArticles:localSet withRemoteSet:obj.articles]; // remove old, outdated articles
-	diff += [self insertArticles:localSet withRemoteSet:obj.articles]; // insert new in correct order
+	ArticleReconcileCount count = [self reconcileArticles:obj.articles];
 	// Get new total article count and post unread-count-change notification
-	if (flag && diff != 0) {
-		PostNotification(kNotificationTotalUnreadCountChanged, @(diff));
+	if (flag && count.unreadDiff != 0) {
+		PostNotification(kNotificationTotalUnreadCountChanged, @(count.unreadDiff));
 	}
+	return count;
+}
+
+/// Append @c fa to list of articles with the same @c key (guids and links are not necessarily unique).
+static inline void IndexArticle(NSMutableDictionary<NSString*, NSMutableArray<FeedArticle*>*> *index, NSString *key, FeedArticle *fa) {
+	NSMutableArray<FeedArticle*> *list = index[key];
+	if (list) [list addObject:fa];
+	else index[key] = [NSMutableArray arrayWithObject:fa];
+}
+
+/// @return Article with lowest @c sortIndex that was not matched yet. Removes returned and already matched articles from list.
+static FeedArticle* TakeUnmatched(NSMutableArray<FeedArticle*> *list, NSSet<FeedArticle*> *matched) {
+	while (list.count > 0) {
+		FeedArticle *fa = list.lastObject; // list is sorted descending
+		[list removeLastObject];
+		if (![matched containsObject:fa])
+			return fa;
+	}
+	return nil;
 }
 
 /**
- Append new articles and increment @c sortIndex and unread count.
- New articles are in ascending order without any gaps in between.
+ Merge remote articles into stored articles. Articles are matched by @c guid (if set) or @c link.
+ Both sides are indexed once, thus the merge runs in @c O(local+remote) instead of @c O(local*remote).
+ Duplicate keys are matched one-to-one (e.g., guid-less articles which all link to the homepage).
  
- @param localSet Use result set of @c deleteArticles:withRemoteSet:
+ 1. Match remote articles with stored articles.
+ 2. Delete all stored articles without a match (except unread articles, if retention policy says so).
+ 3. Renumber kept unread articles, they are placed below all remote articles.
+ 4. Update matching articles and append new ones. Ascending @c sortIndex without any gaps in between.
  */
-- (NSUInteger)insertArticles:(NSMutableSet<FeedArticle*>*)localSet withRemoteSet:(NSArray<RSParsedArticle*>*)remoteSet {
-	int32_t currentIndex = [[localSet valueForKeyPath:@"@min.sortIndex"] intValue];
-	NSUInteger c = 0;
-	for (RSParsedArticle *article in [remoteSet reverseObjectEnumerator]) {
-		// Reverse enumeration ensures correct article order
-		FeedArticle *stored = [self findRemoteArticle:article inLocalSet:localSet];
-		if (stored) {
-			[localSet removeObject:stored];
-			if (stored.sortIndex != currentIndex)
-				stored.sortIndex = currentIndex; // Ensures block of ascending indices
+- (ArticleReconcileCount)reconcileArticles:(NSArray<RSParsedArticle*>*)remoteSet {
+	ArticleReconcileCount count = {0, 0, 0, 0, 0};
+	// Index local articles
+	NSSet<FeedArticle*> *localSet = self.articles;
+	NSMutableDictionary<NSString*, NSMutableArray<FeedArticle*>*> *localGuids = [NSMutableDictionary dictionaryWithCapacity:localSet.count];
+	NSMutableDictionary<NSString*, NSMutableArray<FeedArticle*>*> *localLinks = [NSMutableDictionary dictionaryWithCapacity:localSet.count];
+	int32_t currentIndex = INT32_MAX;
+	for (FeedArticle *fa in localSet) {
+		if (fa.guid) IndexArticle(localGuids, fa.guid, fa);
+		if (fa.link) IndexArticle(localLinks, fa.link, fa);
+		if (fa.sortIndex < currentIndex)
+			currentIndex = fa.sortIndex;
+	}
+	if (currentIndex == INT32_MAX)
+		currentIndex = 0;
+	// Duplicates are consumed oldest first, same order as the remote articles below
+	NSSortDescriptor *desc = [NSSortDescriptor sortDescriptorWithKey:@"sortIndex" ascending:NO];
+	for (NSMutableArray<FeedArticle*> *list in localGuids.objectEnumerator) if (list.count > 1) [list sortUsingDescriptors:@[desc]];
+	for (NSMutableArray<FeedArticle*> *list in localLinks.objectEnumerator) if (list.count > 1) [list sortUsingDescriptors:@[desc]];
+	
+	// Match remote articles (reverse enumeration ensures correct article order)
+	NSArray<RSParsedArticle*> *remoteOrdered = [[remoteSet reverseObjectEnumerator] allObjects];
+	NSMutableArray *stored = [NSMutableArray arrayWithCapacity:remoteOrdered.count]; // FeedArticle or NSNull
+	NSMutableSet<FeedArticle*> *matched = [NSMutableSet setWithCapacity:localSet.count];
+	for (RSParsedArticle *article in remoteOrdered) {
+		NSMutableArray<FeedArticle*> *candidates = (article.guid ? localGuids[article.guid] : (article.link ? localLinks[article.link] : nil));
+		FeedArticle *fa = (candidates ? TakeUnmatched(candidates, matched) : nil);
+		if (fa) [matched addObject:fa];
+		[stored addObject:fa ?: (id)[NSNull null]];
+	}
+	
+	// Delete or keep articles that aren't present in remote anymore (incl. surplus duplicates)
+	NSMutableSet<FeedArticle*> *deletingSet = [NSMutableSet set];
+	NSMutableArray<FeedArticle*> *keptSet = [NSMutableArray array];
+	int32_t unreadKept = 0;
+	BOOL keepUnread = [self.meta effectiveRetention].keepUnread;
+	for (FeedArticle *fa in localSet) {
+		if ([matched containsObject:fa]) {
+			if (fa.unread) unreadKept += 1;
+		} else if (keepUnread && fa.unread) {
+			unreadKept += 1; // will be pruned by count or age limit (see StoreCoordinator)
+			[keptSet addObject:fa];
+		} else {
+			[deletingSet addObject:fa];
+		}
+	}
+	[self deleteArticles:deletingSet count:&count];
+	// Kept articles are older than any remote article, keep their relative order
+	[keptSet sortUsingDescriptors:@[[NSSortDescriptor sortDescriptorWithKey:@"sortIndex" ascending:YES]]];
+	for (FeedArticle *fa in keptSet) {
+		if (fa.sortIndex != currentIndex)
+			fa.sortIndex = currentIndex;
+		currentIndex += 1;
+	}
+	
+	// Update existing and insert new articles
+	for (NSUInteger i = 0; i < remoteOrdered.count; i++) {
+		RSParsedArticle *article = remoteOrdered[i];
+		FeedArticle *fa = stored[i];
+		if (fa != (id)[NSNull null]) {
+			if (fa.sortIndex != currentIndex)
+				fa.sortIndex = currentIndex; // Ensures block of ascending indices
 			// replace local values with remote changes (if any)
-			[stored updateArticleIfChanged:article];
+			if (![fa updateArticleIfChanged:article])
+				count.unchanged += 1;
+			count.updated += 1;
 		} else {
 			FeedArticle *newArticle = [FeedArticle newArticle:article inContext:self.managedObjectContext];
 			newArticle.sortIndex = currentIndex;
 			[self addArticlesObject:newArticle];
-			c += 1;
+			count.inserted += 1;
+			count.unreadDiff += 1;
 		}
 		currentIndex += 1;
 	}
-	return c;
+	// All articles are in memory anyway, set exact values instead of applying the difference
+	[self setUnreadCount:unreadKept + (int32_t)count.inserted total:(int32_t)self.articles.count];
+	return count;
 }
 
-/**
- Delete all articles from core data, that aren't present anymore.
- 
- @param localSet Input a copy of @c self.articles . Output same set minus deleted articles.
- */
-- (NSUInteger)deleteArticles:(NSMutableSet<FeedArticle*>*)localSet withRemoteSet:(NSArray<RSParsedArticle*>*)remoteSet {
-	NSUInteger c = 0;
-	NSMutableSet<FeedArticle*> *deletingSet = [NSMutableSet setWithCapacity:localSet.count];
-	NSMutableArray *dismissed = [NSMutableArray array];
-	for (FeedArticle *fa in localSet) {
-		if (![self findLocalArticle:fa inRemoteSet:remoteSet]) {
-			if (fa.unread) ++c;
-			// TODO: keep unread articles?
-			[dismissed addObject:fa.notificationID];
-			[self.managedObjectContext deleteObject:fa];
-			[deletingSet addObject:fa];
-		}
+/// Delete articles from core data and dismiss delivered notifications. Increments @c deleted and decrements @c unreadDiff.
+- (void)deleteArticles:(NSSet<FeedArticle*>*)deletingSet count:(ArticleReconcileCount*)count {
+	if (deletingSet.count == 0)
+		return;
+	NSMutableArray *dismissed = [NSMutableArray arrayWithCapacity:deletingSet.count];
+	for (FeedArticle *fa in deletingSet) {
+		if (fa.unread) count->unreadDiff -= 1;
+		[dismissed addObject:fa.notificationID];
+		[self.managedObjectContext deleteObject:fa];
 	}
-	if (deletingSet.count > 0) {
-		[localSet minusSet:deletingSet];
-		[self removeArticles:deletingSet];
-		if (@available(macOS 10.14, *)) {
-			[NotifyEndpoint dismiss:dismissed];
-		}
+	count->deleted += deletingSet.count;
+	[self removeArticles:deletingSet];
+	if (@available(macOS 10.14, *)) {
+		[NotifyEndpoint dismiss:dismissed];
 	}
-	return c;
 }
 
 
@@ -150,69 +220,79 @@
 }
 
 /**
- Iterate over localSet and return the one where @c link and @c guid matches. Or @c nil if no matching article found.
+ @return Publishing dates of all articles (duplicates included, may contain @c NSNull ).
+ Saved articles are read with a dictionary fetch (no article faults), unsaved inserts and deletes are applied on top.
  */
-- (FeedArticle*)findRemoteArticle:(RSParsedArticle*)remote inLocalSet:(NSSet<FeedArticle*>*)localSet {
-	NSString *searchLink = remote.link;
-	NSString *searchGuid = remote.guid;
-	for (FeedArticle *art in localSet) {
-		// assuming if a guid is set, it will always be unique
-		if (searchGuid != nil) {
-			if ([art.guid isEqualToString:searchGuid])
-				return art;
-		} else if (searchLink != nil) {
-			if ([art.link isEqualToString:searchLink])
-				return art;
-		}
+- (NSArray<NSDate*>*)publishedDates {
+	NSManagedObjectContext *moc = self.managedObjectContext;
+	NSMutableArray<FeedArticle*> *deleted = [NSMutableArray array];
+	for (NSManagedObject *obj in moc.deletedObjects) {
+		if ([obj isKindOfClass:[FeedArticle class]])
+			[deleted addObject:(FeedArticle*)obj];
 	}
-	return nil;
-}
-
-/**
- Iterate over remoteSet and return the one where @c link and @c guid matches. Or @c nil if no matching article found.
- */
-- (RSParsedArticle*)findLocalArticle:(FeedArticle*)local inRemoteSet:(NSArray<RSParsedArticle*>*)remoteSet {
-	NSString *searchLink = local.link;
-	NSString *searchGuid = local.guid;
-	for (RSParsedArticle *art in remoteSet) {
-		// assuming if a guid is set, it will always be unique
-		if (searchGuid != nil) {
-			if ([art.guid isEqualToString:searchGuid])
-				return art;
-		} else if (searchLink != nil) {
-			if ([art.link isEqualToString:searchLink])
-				return art;
-		}
+	NSFetchRequest *fr = [FeedArticle fetchRequest];
+	if (deleted.count > 0)
+		[fr where:@"feed = %@ AND NOT (SELF IN %@)", self, deleted];
+	else
+		[fr where:@"feed = %@", self];
+	NSMutableArray *dates = [[[[fr select:@[@"published"]] fetchAllRows:moc] valueForKey:@"published"] mutableCopy];
+	for (NSManagedObject *obj in moc.insertedObjects) {
+		if ([obj isKindOfClass:[FeedArticle class]] && ((FeedArticle*)obj).feed == self && ((FeedArticle*)obj).published)
+			[dates addObject:((FeedArticle*)obj).published];
 	}
-	return nil;
+	return dates;
 }
 
-/// Number of unread articles
+/// Number of unread articles. Stored value, no need to fetch articles.
 - (NSUInteger)countUnread {
-	NSUInteger count = 0;
-	for (FeedArticle *article in self.articles) {
-		if (article.unread)
-			count += 1;
-	}
-	return count;
+	return (NSUInteger)MAX(0, self.unreadCount);
+}
+
+/// Add relative change to stored @c unreadCount (e.g., after marking articles read). Will not drop below zero.
+- (void)addUnreadCount:(NSInteger)diff {
+	if (diff != 0)
+		self.unreadCount = (int32_t)MAX(0, self.unreadCount + diff);
+}
+
+/// Set stored @c unreadCount and @c totalCount but only if values differ.
+- (void)setUnreadCount:(int32_t)unread total:(int32_t)total {
+	if (self.unreadCount != unread) self.unreadCount = unread;
+	if (self.totalCount != total)   self.totalCount = total;
 }
 
 
 #pragma mark - Icon -
 
 
+/// Decoded favicons keyed by @c objectID. Prevents file read and image decoding on every menu rebuild.
+static NSCache<NSManagedObjectID*, NSImage*>* IconCache(void) {
+	static NSCache *cache;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		cache = [NSCache new];
+		cache.countLimit = 500; // also evicts on memory pressure
+	});
+	return cache;
+}
+
 /// @return @c 16x16px image. Either from favicon cache or generated default RSS icon.
 - (nonnull NSImage*)iconImage16 {
-	NSImage *img = nil;
-	if (self.articles.count == 0) {
-		img = [NSImage imageNamed:NSImageNameCaution];
-	} else if (self.hasIcon) {
-		NSData* data = [[NSData alloc] initWithContentsOfURL:[self iconPath]];
-		img = [[NSImage alloc] initWithData:data];
-	} else {
+	if (self.totalCount == 0) {
+		NSImage *img = [NSImage imageNamed:NSImageNameCaution];
+		[img setSize:NSMakeSize(16, 16)];
+		return img;
+	}
+	NSImage *img = [IconCache() objectForKey:self.objectID];
+	if (img)
+		return img;
+	// Favicons are stored pre-scaled, but older versions stored the original image
+	img = [FaviconDownload iconWithData:[[NSData alloc] initWithContentsOfURL:[self iconPath]]];
+	if (!img) {
 		img = [NSImage imageNamed:RSSImageDefaultRSSIcon];
+		[img setSize:NSMakeSize(16, 16)];
 	}
-	[img setSize:NSMakeSize(16, 16)];
+	if (!self.objectID.isTemporaryID)
+		[IconCache() setObject:img forKey:self.objectID];
 	return img;
 }
 
@@ -226,6 +306,7 @@
 
 /// Move favicon from @c $TMPDIR to permanent destination in Application Support.
 - (void)setNewIcon:(NSURL*)location {
+	[IconCache() removeObjectForKey:self.objectID]; // before posting notification
 	if (!location) {
 		[[self iconPath] remove];
 	} else {
@@ -237,4 +318,55 @@
 	}
 }
 
+
+#ifdef DEBUG
+#pragma mark - Benchmark (DEBUG) -
+
+
+/// @return Parsed feed with @c count articles, starting at article number @c first . Every 10th article has no guid and links to the homepage.
+static RSParsedFeed* BenchmarkFeed(NSUInteger count, NSUInteger first) {
+	RSParsedFeed *feed = [[RSParsedFeed alloc] initWithURL:[NSURL URLWithString:@"https://example.org/feed"]];
+	feed.link = @"https://example.org";
+	for (NSUInteger i = first + count; i > first; i--) { // newest first
+		RSParsedArticle *article = [feed appendNewArticle];
+		if (i % 10 == 0) {
+			article.link = @"https://example.org"; // duplicate key
+		} else {
+			article.guid = [NSString stringWithFormat:@"%lu", i];
+			article.link = [NSString stringWithFormat:@"https://example.org/%lu", i];
+		}
+		article.title = [NSString stringWithFormat:@"Article %lu", i];
+		article.body = @"<p>Lorem ipsum dolor sit amet, consectetur adipiscing elit.</p>";
+		article.datePublished = [NSDate dateWithTimeIntervalSince1970:1577836800 + i * 3600];
+	}
+	return feed;
+}
+
+/**
+ Developer tool. Print duration of @c updateWithRSS: for feeds with 10, 1k, and 10k articles on an in-memory store.
+ Each feed is merged three times: into an empty feed, with 10% new articles, and unchanged.
+ Article count must not grow after the last merge. Started with @c barss:config/benchmark/reconcile
+ */
++ (void)benchmarkReconcile {
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+		NSManagedObjectContext *moc = [StoreCoordinator createBenchmarkContext];
+		[moc performBlockAndWait:^{
+			for (NSNumber *num in @[@10, @1000, @10000]) {
+				NSUInteger n = num.unsignedIntegerValue;
+				RSParsedFeed *initial = BenchmarkFeed(n, 0);
+				RSParsedFeed *changed = BenchmarkFeed(n, n / 10);
+				Feed *feed = [Feed newFeedAndMetaInContext:moc];
+				printf("--- reconcile %lu articles ---\n", n);
+				benchmark("insert all", ^{ [feed updateWithRSS:initial postUnreadCountChange:NO]; });
+				benchmark("merge 10% new", ^{ [feed updateWithRSS:changed postUnreadCountChange:NO]; });
+				NSUInteger before = feed.articles.count;
+				benchmark("merge unchanged", ^{ [feed updateWithRSS:changed postUnreadCountChange:NO]; });
+				printf("articles: %lu -> %lu (%s)\n", before, feed.articles.count, before == feed.articles.count ? "stable" : "GROWING");
+				[moc reset];
+			}
+		}];
+	});
+}
+#endif
+
 @end
@@ -5,9 +5,10 @@
 NS_ASSUME_NONNULL_BEGIN
 
 @interface FeedArticle (Ext)
++ (NSUInteger)skippedConversions;
 + (instancetype)newArticle:(RSParsedArticle*)entry inContext:(NSManagedObjectContext*)moc;
 - (NSString*)notificationID;
-- (void)updateArticleIfChanged:(RSParsedArticle*)entry;
+- (BOOL)updateArticleIfChanged:(RSParsedArticle*)entry;
 - (NSMenuItem*)newMenuItem;
 @end
 
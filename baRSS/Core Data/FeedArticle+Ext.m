@@ -7,12 +7,50 @@
 #import "NotifyEndpoint.h"
 #import "NSString+Ext.h"
 
+#include <stdatomic.h>
+
+static _Atomic(NSUInteger) _skippedConversions = 0;
+
+/// 64 bit FNV-1a hash over UTF-8 bytes. Continues with previous @c hash value.
+static inline uint64_t DigestAppend(uint64_t hash, NSString *str) {
+	const unsigned char *s = (const unsigned char*)str.UTF8String;
+	if (s) {
+		while (*s) {
+			hash ^= *s++;
+			hash *= 0x100000001b3ULL;
+		}
+	}
+	hash ^= 0x1F; // unit separator, so that "ab"+"c" != "a"+"bc"
+	return hash * 0x100000001b3ULL;
+}
+
+/// @return Content digest over all fields of a parsed article. Used to detect unchanged articles without HTML conversion.
+static int64_t ArticleDigest(RSParsedArticle *entry) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	hash = DigestAppend(hash, entry.guid);
+	hash = DigestAppend(hash, entry.title);
+	hash = DigestAppend(hash, entry.author);
+	hash = DigestAppend(hash, entry.abstract);
+	hash = DigestAppend(hash, entry.body);
+	hash = DigestAppend(hash, entry.link);
+	NSDate *date = entry.datePublished ? entry.datePublished : entry.dateModified;
+	double time = date ? date.timeIntervalSinceReferenceDate : 0;
+	uint64_t bits;
+	memcpy(&bits, &time, sizeof(bits));
+	hash = (hash ^ bits) * 0x100000001b3ULL;
+	return (int64_t)(hash ? hash : 1); // 0 is reserved for articles without digest
+}
+
 @implementation FeedArticle (Ext)
 
+/// @return Number of article updates where HTML conversion was skipped because the content digest did not change.
++ (NSUInteger)skippedConversions { return _skippedConversions; }
+
 /// Create new article based on RSXML article input.
 + (instancetype)newArticle:(RSParsedArticle*)entry inContext:(NSManagedObjectContext*)moc {
 	FeedArticle *fa = [[FeedArticle alloc] initWithEntity:FeedArticle.entity insertIntoManagedObjectContext:moc];
 	fa.unread = YES;
+	fa.digest = ArticleDigest(entry);
 	fa.guid = entry.guid;
 	fa.title = entry.title;
 	if (entry.abstract.length > 0)
@@ -32,7 +70,18 @@
 	return self.objectID.URIRepresentation.absoluteString;
 }
 
-- (void)updateArticleIfChanged:(RSParsedArticle*)entry {
+/**
+ Replace local values with remote changes. Will skip HTML conversion and setters if content digest matches.
+ 
+ @return @c NO if article is unchanged.
+ */
+- (BOOL)updateArticleIfChanged:(RSParsedArticle*)entry {
+	int64_t digest = ArticleDigest(entry);
+	if (self.digest == digest) {
+		atomic_fetch_add(&_skippedConversions, 1);
+		return NO;
+	}
+	self.digest = digest;
 	[self setGuidIfChanged:entry.guid];
 	[self setTitleIfChanged:entry.title];
 	[self setAuthorIfChanged:entry.author];
@@ -40,6 +89,7 @@
 	[self setBodyIfChanged:(entry.body.length > 0) ? [entry.body htmlToPlainText] : nil];
 	[self setLinkIfChanged:(entry.link.length > 0) ? entry.link : entry.guid];
 	[self setPublishedIfChanged:entry.datePublished ? entry.datePublished : entry.dateModified];
+	return YES;
 }
 
 /// @return Full or truncated article title, based on user preference in settings.
@@ -87,6 +137,7 @@
 		success = UserPrefsOpenURL(url);
 	if (flipUnread || (success && fa.unread)) {
 		fa.unread = !fa.unread;
+		[fa.feed addUnreadCount:(fa.unread ? +1 : -1)];
 		[StoreCoordinator saveContext:moc andParent:YES];
 		NSNumber *num = (fa.unread ? @+1 : @-1);
 		PostNotification(kNotificationTotalUnreadCountChanged, num);
@@ -18,12 +18,14 @@ NS_ASSUME_NONNULL_BEGIN
 
 + (instancetype)newGroup:(FeedGroupType)type inContext:(NSManagedObjectContext*)context;
 + (instancetype)appendToRoot:(FeedGroupType)type inContext:(NSManagedObjectContext*)moc;
-- (void)setParent:(nullable FeedGroup *)parent andSortIndex:(int32_t)sortIndex;
-- (void)setSortIndexIfChanged:(int32_t)sortIndex;
+- (void)setParent:(nullable FeedGroup *)parent andSortIndex:(int32_t)sortIndex siblings:(NSUInteger)count;
+- (void)setSortIndexIfChanged:(int32_t)sortIndex siblings:(NSUInteger)count;
+- (void)updateTreeInterval:(BOOL)force siblings:(NSUInteger)count;
 - (void)setNameIfChanged:(nullable NSString*)name;
 - (NSMenuItem*)newMenuItem;
 // Handle children and parents
 - (NSString*)indexPathString;
+- (BOOL)hasTreeInterval;
 - (nullable NSArray<FeedGroup*>*)sortedChildren;
 - (NSMutableArray<FeedGroup*>*)allParents;
 // Printing
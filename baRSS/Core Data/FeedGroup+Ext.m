@@ -2,6 +2,35 @@
 #import "Feed+Ext.h"
 #import "StoreCoordinator.h"
 
+/// Upper bound of nested interval for root level items (leaves room for overflow-free arithmetic).
+static int64_t const kTreeRootUpper = (int64_t)1 << 62;
+/// Min. number of child slots per group. Doubled whenever a group gets more children.
+static int64_t const kTreeMinSlots = 32;
+
+/// @return Number of child slots for a group with @c count children.
+static int64_t TreeSlotCount(NSUInteger count) {
+	int64_t slots = kTreeMinSlots;
+	while (slots <= (int64_t)count)
+		slots *= 2;
+	return slots;
+}
+
+/**
+ Nested interval of child at @c index in parent interval @c [lower,upper) with @c count children.
+ The parent keeps @c lower for itself, the remaining range is split in equally sized slots.
+ If the parent interval is too small (deep nesting), both values are set to @c 0 (no interval).
+ */
+static void TreeSlot(int64_t lower, int64_t upper, NSUInteger count, int32_t index, int64_t *outLower, int64_t *outUpper) {
+	int64_t slots = TreeSlotCount(count);
+	int64_t width = (upper - lower - 1) / slots;
+	if (upper <= lower || width < 1 || index < 0 || index >= slots) {
+		*outLower = *outUpper = 0;
+		return;
+	}
+	*outLower = lower + 1 + index * width;
+	*outUpper = *outLower + width;
+}
+
 @implementation FeedGroup (Ext)
 
 #pragma mark - Properties
@@ -51,27 +80,67 @@
 + (instancetype)appendToRoot:(FeedGroupType)type inContext:(NSManagedObjectContext*)moc {
 	NSUInteger lastIndex = [StoreCoordinator countRootItemsInContext:moc];
 	FeedGroup *fg = [FeedGroup newGroup:type inContext:moc];
-	[fg setParent:nil andSortIndex:(int32_t)lastIndex];
+	[fg setParent:nil andSortIndex:(int32_t)lastIndex siblings:lastIndex + 1];
 	return fg;
 }
 
-/// Set @c parent and @c sortIndex. Also if type is @c FEED calculate and set @c indexPath string.
-- (void)setParent:(nullable FeedGroup *)parent andSortIndex:(int32_t)sortIndex {
+/**
+ Set @c parent and @c sortIndex. Update nested interval and @c indexPath string of all descendants (if changed).
+ If the item is appended as last child and the slot count grows, all siblings are updated too.
+ 
+ @param count Number of children of @c parent (including @c self ). Either the current or the final count of a bulk insert.
+ */
+- (void)setParent:(nullable FeedGroup *)parent andSortIndex:(int32_t)sortIndex siblings:(NSUInteger)count {
 	self.parent = parent;
 	self.sortIndex = sortIndex;
-	if (self.type == FEED)
-		[self.feed calculateAndSetIndexPathString];
+	[self updateTreeInterval:NO siblings:count];
+	// slot size depends on number of siblings, previous siblings were placed with one slot less
+	if ((NSUInteger)sortIndex + 1 == count && TreeSlotCount(count) != TreeSlotCount(count - 1)) {
+		for (FeedGroup *fg in (parent ? parent.children : [StoreCoordinator sortedFeedGroupsWithParent:nil inContext:self.managedObjectContext]))
+			[fg updateTreeInterval:NO siblings:count];
+	}
 }
 
-/// Set @c sortIndex of @c FeedGroup. Iterate over all @c Feed child items and update @c indexPath string.
-- (void)setSortIndexIfChanged:(int32_t)sortIndex {
+/**
+ Set @c sortIndex of @c FeedGroup. Update nested interval and @c indexPath string of all descendants (if changed).
+ @param count Number of children of @c parent (including @c self ).
+ */
+- (void)setSortIndexIfChanged:(int32_t)sortIndex siblings:(NSUInteger)count {
 	if (self.sortIndex != sortIndex) {
 		self.sortIndex = sortIndex;
 	}
-	// Otherwise move from 0.0 -> 0 will not trigger index path update
-	[self iterateSorted:NO overDescendantFeeds:^(Feed *feed, BOOL *cancel) {
-		[feed calculateAndSetIndexPathString];
-	}];
+	// Even if unchanged, parent may have changed (e.g., move from 0.0 -> 0)
+	[self updateTreeInterval:NO siblings:count];
+}
+
+/**
+ Recalculate nested interval from @c parent interval and @c sortIndex. Also set @c Feed.indexPath string.
+ Descendants are only updated if the interval changed (or if there is no interval due to deep nesting).
+ 
+ @param force If @c YES update all descendants regardless.
+ @param count Number of children of @c parent (including @c self ). Root items are not counted in the store.
+ */
+- (void)updateTreeInterval:(BOOL)force siblings:(NSUInteger)count {
+	int64_t lower, upper;
+	[self calculateTreeInterval:&lower upper:&upper siblings:count];
+	if (!force && upper > lower && self.treeLower == lower && self.treeUpper == upper)
+		return;
+	if (self.treeLower != lower) self.treeLower = lower;
+	if (self.treeUpper != upper) self.treeUpper = upper;
+	if (self.type == FEED)
+		[self.feed calculateAndSetIndexPathString];
+	NSSet<FeedGroup*> *children = self.children;
+	for (FeedGroup *fg in children)
+		[fg updateTreeInterval:force siblings:children.count];
+}
+
+/// Calculate nested interval based on @c parent interval and number of siblings. Does not modify any attribute.
+- (void)calculateTreeInterval:(int64_t*)lower upper:(int64_t*)upper siblings:(NSUInteger)count {
+	if (self.parent) {
+		TreeSlot(self.parent.treeLower, self.parent.treeUpper, count, self.sortIndex, lower, upper);
+	} else {
+		TreeSlot(0, kTreeRootUpper, count, self.sortIndex, lower, upper);
+	}
 }
 
 /// Set @c name attribute but only if value differs.
@@ -105,6 +174,11 @@
 	return [[self.parent indexPathString] stringByAppendingFormat:@".%d", self.sortIndex];
 }
 
+/// @return @c YES if nested interval is set. Otherwise, nesting is too deep (or not yet initialized).
+- (BOOL)hasTreeInterval {
+	return self.treeUpper > self.treeLower;
+}
+
 /// @return Children sorted by attribute @c sortIndex (same order as in preferences).
 - (nullable NSArray<FeedGroup*>*)sortedChildren {
 	if (self.children.count == 0)
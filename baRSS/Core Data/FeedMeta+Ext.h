@@ -2,6 +2,18 @@
 #import "FeedMeta+CoreDataClass.h"
 
 static int32_t const kDefaultFeedRefreshInterval = 30 * 60;
+/// Special @c refresh value. Interval is learned from article publishing dates (see @c autoRefresh ).
+/// Any other value @c <= @c 0 (incl. model default @c -1 ) disables scheduled updates.
+static int32_t const kFeedRefreshAuto = -2;
+/// Special @c retainUnread value. Use global setting @c Pref_retainUnread .
+static int16_t const kFeedRetainDefault = -1;
+
+/// Effective article retention policy of a single feed. @c 0 means unlimited.
+typedef struct {
+	NSUInteger maxCount, maxDays;
+	/// If @c YES , unread articles are neither pruned nor removed if missing in the remote feed.
+	BOOL keepUnread;
+} ArticleRetention;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -14,6 +26,12 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)setUrlIfChanged:(NSString*)url;
 - (void)setRefreshIfChanged:(int32_t)refresh;
 - (void)scheduleNow:(NSTimeInterval)future;
+- (void)setRetainCount:(int32_t)count days:(int32_t)days unread:(int16_t)unread;
+// Retention
+- (ArticleRetention)effectiveRetention;
+// Automatic refresh
+- (int32_t)effectiveRefresh;
+- (void)learnRefreshFromDates:(NSArray<NSDate*>*)dates;
 @end
 
 NS_ASSUME_NONNULL_END
@@ -1,6 +1,13 @@
 #import "FeedMeta+Ext.h"
 #import "Feed+Ext.h"
 #import "FeedGroup+Ext.h"
+#import "NSDate+Ext.h"
+#import "UserPrefs.h"
+
+/// Lower bound for learned refresh interval.
+static int32_t const kAutoRefreshMin = 15 * 60;
+/// Upper bound for learned refresh interval.
+static int32_t const kAutoRefreshMax = 12 * 60 * 60;
 
 @implementation FeedMeta (Ext)
 
@@ -37,7 +44,7 @@
 		[self setEtag:header[@"Etag"] modified:header[@"Last-Modified"]];
 		[self setUrlIfChanged:response.URL.absoluteString];
 	}
-	[self scheduleNow:self.refresh];
+	[self scheduleNow:[self effectiveRefresh]];
 }
 
 #pragma mark - Setter
@@ -52,20 +59,113 @@
 	if (self.refresh != refresh) self.refresh = refresh;
 }
 
+/// Set @c retainCount , @c retainDays and @c retainUnread attributes. Only values that differ will be updated.
+- (void)setRetainCount:(int32_t)count days:(int32_t)days unread:(int16_t)unread {
+	if (self.retainCount != count)   self.retainCount = count;
+	if (self.retainDays != days)     self.retainDays = days;
+	if (self.retainUnread != unread) self.retainUnread = unread;
+}
+
 /// Set @c etag and @c modified attributes. Only values that differ will be updated.
 - (void)setEtag:(NSString*)etag modified:(NSString*)modified {
 	if (![self.etag isEqualToString:etag])         self.etag = etag;
 	if (![self.modified isEqualToString:modified]) self.modified = modified;
 }
 
-/// Set next scheduled feed update or @c nil if @c refresh @c <= @c 0.
+/**
+ Set next scheduled feed update or @c nil if @c refresh @c <= @c 0 (except @c kFeedRefreshAuto ).
+ If @c refresh is @c kFeedRefreshAuto , the date is postponed to the next hour with publishing activity.
+ */
 - (void)scheduleNow:(NSTimeInterval)future {
-	if (self.refresh <= 0) { // update deactivated; manually update with force update all
+	if (self.refresh <= 0 && self.refresh != kFeedRefreshAuto) { // update deactivated; manually update with force update all
 		if (self.scheduled != nil) // already nil? Avoid unnecessary core data edits
 			self.scheduled = nil;
 	} else {
-		self.scheduled = [NSDate dateWithTimeIntervalSinceNow:future];
+		NSDate *date = [NSDate dateWithTimeIntervalSinceNow:future];
+		if (self.refresh == kFeedRefreshAuto)
+			date = [self postponeToActiveHour:date limit:[NSDate dateWithTimeIntervalSinceNow:MAX(future, kAutoRefreshMax)]];
+		self.scheduled = date;
+	}
+}
+
+#pragma mark - Retention
+
+/// @return Per feed retention values. Unset values ( @c 0 or @c kFeedRetainDefault ) are replaced with global settings.
+- (ArticleRetention)effectiveRetention {
+	ArticleRetention policy;
+	policy.maxCount = (self.retainCount > 0 ? (NSUInteger)self.retainCount : UserPrefsUInt(Pref_retainArticleCount));
+	policy.maxDays = (self.retainDays > 0 ? (NSUInteger)self.retainDays : UserPrefsUInt(Pref_retainArticleDays));
+	policy.keepUnread = (self.retainUnread == kFeedRetainDefault ? UserPrefsBool(Pref_retainUnread) : self.retainUnread > 0);
+	return policy;
+}
+
+#pragma mark - Automatic Refresh
+
+/// @return Interval used for scheduling. Either @c refresh , learned @c autoRefresh , or @c 0 if deactivated.
+- (int32_t)effectiveRefresh {
+	if (self.refresh != kFeedRefreshAuto)
+		return MAX(0, self.refresh);
+	return (self.autoRefresh > 0 ? self.autoRefresh : kDefaultFeedRefreshInterval);
+}
+
+/**
+ Recompute @c autoRefresh and @c activeHours from article publishing dates and reschedule.
+ Does nothing unless @c refresh is @c kFeedRefreshAuto .
+ 
+ Target interval is a quarter of the median gap between articles (between 15 min and 12 hours).
+ Previous value is smoothed towards target, but will change at most by factor 2 per update.
+ */
+- (void)learnRefreshFromDates:(NSArray<NSDate*>*)dates {
+	if (self.refresh != kFeedRefreshAuto)
+		return;
+	NSMutableArray<NSDate*> *sorted = [NSMutableArray arrayWithCapacity:dates.count];
+	for (NSDate *d in dates) {
+		if ([d isKindOfClass:[NSDate class]]) // because dictionary fetch can return NSNull
+			[sorted addObject:d];
+	}
+	[sorted sortUsingSelector:@selector(compare:)];
+	NSDictionary *stats = [NSDate refreshIntervalStatistics:sorted];
+	if (!stats)
+		return;
+	// exponential smoothing, bounded
+	double target = [stats[@"median"] doubleValue] / 4;
+	double prev = (self.autoRefresh > 0 ? self.autoRefresh : kDefaultFeedRefreshInterval);
+	double next = prev + 0.3 * (target - prev);
+	next = MAX(prev / 2, MIN(prev * 2, next));
+	int32_t interval = (int32_t)MAX(kAutoRefreshMin, MIN(kAutoRefreshMax, next));
+	if (self.autoRefresh != interval)
+		self.autoRefresh = interval;
+	// hour-of-day bitmask (local time), including the hour after publishing
+	int32_t mask = 0;
+	if (sorted.count >= 8) { // not enough data for a meaningful pattern
+		NSCalendar *cal = [NSCalendar currentCalendar];
+		for (NSDate *d in sorted) {
+			NSInteger h = [cal component:NSCalendarUnitHour fromDate:d];
+			mask |= (1 << h) | (1 << ((h + 1) % 24));
+		}
+		if (mask == 0xFFFFFF)
+			mask = 0;
+	}
+	if (self.activeHours != mask)
+		self.activeHours = mask;
+	[self scheduleNow:interval];
+}
+
+/// @return Either @c date (if in active hour), the beginning of the next active hour, or @c limit (whichever is earliest).
+- (NSDate*)postponeToActiveHour:(NSDate*)date limit:(NSDate*)limit {
+	int32_t mask = self.activeHours;
+	if (mask == 0)
+		return date;
+	NSCalendar *cal = [NSCalendar currentCalendar];
+	if (mask & (1 << [cal component:NSCalendarUnitHour fromDate:date]))
+		return date;
+	NSDate *hourStart = [cal dateFromComponents:[cal components:NSCalendarUnitYear | NSCalendarUnitMonth | NSCalendarUnitDay | NSCalendarUnitHour fromDate:date]];
+	for (int i = 1; i <= 24; i++) {
+		NSDate *next = [hourStart dateByAddingTimeInterval:i * TimeUnitHours];
+		if (mask & (1 << [cal component:NSCalendarUnitHour fromDate:next]))
+			return [next earlierDate:limit];
 	}
+	return date;
 }
 
 @end
@@ -15,6 +15,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (instancetype)where:(NSString*)format, ...; // sets .predicate
 - (instancetype)sortASC:(NSString*)key; // add .sortDescriptors -> ascending:YES
 - (instancetype)sortDESC:(NSString*)key; // add .sortDescriptors -> ascending:NO
+- (instancetype)prefetch:(NSArray<NSString*>*)keyPaths; // sets .relationshipKeyPathsForPrefetching
 - (instancetype)addFunctionExpression:(NSString*)fn onKeyPath:(NSString*)keyPath name:(NSString*)name type:(NSAttributeType)type; // add .propertiesToFetch -> (expressionForFunction:@[expressionForKeyPath:])
 @end
 
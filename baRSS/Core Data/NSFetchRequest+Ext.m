@@ -77,6 +77,15 @@
 	return self;
 }
 
+/**
+ Set @c self.relationshipKeyPathsForPrefetching = @c keyPaths (load related objects with the same request).
+ @return @c self (e.g., method chaining)
+ */
+- (instancetype)prefetch:(NSArray<NSString*>*)keyPaths {
+	self.relationshipKeyPathsForPrefetching = keyPaths;
+	return self;
+}
+
 /**
  Add new [NSExpression expressionForFunction: @c fn arguments: [NSExpression expressionForKeyPath: @c keyPath ]] to @c self.propertiesToFetch.
  Also set @c self.includesPropertyValues @c = @c NO and @c self.resultType @c = @c NSDictionaryResultType.
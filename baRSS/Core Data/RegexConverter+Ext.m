@@ -1,4 +1,5 @@
 #import "RegexConverter+Ext.h"
+#import "RegexFeed.h"
 
 @implementation RegexConverter (Ext)
 
@@ -10,60 +11,78 @@
 /// Set @c entry attribute but only if value differs.
 - (void)setEntryIfChanged:(nullable NSString*)pattern {
 	if (pattern.length == 0) {
-		if (self.entry.length > 0)
+		if (self.entry.length > 0) {
 			self.entry = nil; // nullify empty strings
+			[RegexFeed invalidateCache:self];
+		}
 	} else if (![self.entry isEqualToString: pattern]) {
 		self.entry = pattern;
+		[RegexFeed invalidateCache:self];
 	}
 }
 
 /// Set @c href attribute but only if value differs.
 - (void)setHrefIfChanged:(nullable NSString*)pattern {
 	if (pattern.length == 0) {
-		if (self.href.length > 0)
+		if (self.href.length > 0) {
 			self.href = nil; // nullify empty strings
+			[RegexFeed invalidateCache:self];
+		}
 	} else if (![self.href isEqualToString: pattern]) {
 		self.href = pattern;
+		[RegexFeed invalidateCache:self];
 	}
 }
 
 /// Set @c title attribute but only if value differs.
 - (void)setTitleIfChanged:(nullable NSString*)pattern {
 	if (pattern.length == 0) {
-		if (self.title.length > 0)
+		if (self.title.length > 0) {
 			self.title = nil; // nullify empty strings
+			[RegexFeed invalidateCache:self];
+		}
 	} else if (![self.title isEqualToString: pattern]) {
 		self.title = pattern;
+		[RegexFeed invalidateCache:self];
 	}
 }
 
 /// Set @c desc attribute but only if value differs.
 - (void)setDescIfChanged:(nullable NSString*)pattern {
 	if (pattern.length == 0) {
-		if (self.desc.length > 0)
+		if (self.desc.length > 0) {
 			self.desc = nil; // nullify empty strings
+			[RegexFeed invalidateCache:self];
+		}
 	} else if (![self.desc isEqualToString: pattern]) {
 		self.desc = pattern;
+		[RegexFeed invalidateCache:self];
 	}
 }
 
 /// Set @c date attribute but only if value differs.
 - (void)setDateIfChanged:(nullable NSString*)pattern {
 	if (pattern.length == 0) {
-		if (self.date.length > 0)
+		if (self.date.length > 0) {
 			self.date = nil; // nullify empty strings
+			[RegexFeed invalidateCache:self];
+		}
 	} else if (![self.date isEqualToString: pattern]) {
 		self.date = pattern;
+		[RegexFeed invalidateCache:self];
 	}
 }
 
 /// Set @c dateFormat attribute but only if value differs.
 - (void)setDateFormatIfChanged:(nullable NSString*)pattern {
 	if (pattern.length == 0) {
-		if (self.dateFormat.length > 0)
+		if (self.dateFormat.length > 0) {
 			self.dateFormat = nil; // nullify empty strings
+			[RegexFeed invalidateCache:self];
+		}
 	} else if (![self.dateFormat isEqualToString: pattern]) {
 		self.dateFormat = pattern;
+		[RegexFeed invalidateCache:self];
 	}
 }
 
@@ -7,7 +7,10 @@ NS_ASSUME_NONNULL_BEGIN
 // Managing contexts
 + (NSManagedObjectContext*)getMainContext;
 + (NSManagedObjectContext*)createChildContext;
++ (NSManagedObjectContext*)createBackgroundContext;
 + (void)saveContext:(NSManagedObjectContext*)context andParent:(BOOL)flag;
++ (void)registerContextForBatchChanges:(NSManagedObjectContext*)moc;
++ (void)mergeBatchChanges:(NSDictionary*)changes;
 
 // Options
 + (nullable NSString*)optionForKey:(NSString*)key;
@@ -26,16 +29,27 @@ NS_ASSUME_NONNULL_BEGIN
 
 // Get List Of Elements
 + (NSArray<FeedGroup*>*)sortedFeedGroupsWithParent:(nullable id)parent inContext:(nullable NSManagedObjectContext*)moc;
++ (NSArray<FeedArticle*>*)sortedArticlesWithParent:(Feed*)parent unreadOnly:(BOOL)flag limit:(NSUInteger)limit inContext:(nullable NSManagedObjectContext*)moc;
 + (Feed*)feedWithIndexPath:(nonnull NSString*)path inContext:(nullable NSManagedObjectContext*)moc;
 + (NSString*)urlForFeedWithIndexPath:(nonnull NSString*)path;
 
 // Unread articles list & mark articled read
 + (NSArray<FeedArticle*>*)articlesAtPath:(nullable NSString*)path isFeed:(BOOL)feedFlag sorted:(BOOL)sortFlag unread:(BOOL)readFlag inContext:(NSManagedObjectContext*)moc limit:(NSUInteger)limit;
++ (NSArray<NSString*>*)markAllArticlesAtPath:(nullable NSString*)path isFeed:(BOOL)feedFlag markRead:(BOOL)markRead;
 + (nullable NSArray<NSString*>*)updateArticles:(NSArray<FeedArticle*>*)list markRead:(BOOL)markRead andOpen:(BOOL)openLinks inContext:(NSManagedObjectContext*)moc;
 
 // Restore sound state
 + (void)cleanupAndShowAlert:(BOOL)flag;
++ (void)restoreFeedIndexPaths;
++ (NSUInteger)restoreFeedCounts;
++ (NSUInteger)pruneArticlesInContext:(NSManagedObjectContext*)moc;
 + (NSUInteger)cleanupFavicons;
+#ifdef DEBUG
++ (NSUInteger)fetchCount;
++ (NSUInteger)faultCount;
++ (void)benchmarkQueries;
++ (NSManagedObjectContext*)createBenchmarkContext;
+#endif
 @end
 
 NS_ASSUME_NONNULL_END
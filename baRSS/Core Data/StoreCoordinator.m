@@ -5,10 +5,26 @@
 #import "UserPrefs.h"
 #import "Feed+Ext.h"
 #import "FeedArticle+Ext.h"
+#import "FeedGroup+Ext.h"
+#import "FeedMeta+Ext.h"
+#import "NotifyEndpoint.h"
 #import "NSURL+Ext.h"
 #import "NSError+Ext.h"
 #import "NSFetchRequest+Ext.h"
 
+#ifdef DEBUG
+#import <objc/runtime.h>
+#include <stdatomic.h>
+#endif
+
+// Prefetch plans, related objects that are accessed right after the fetch (avoid one round-trip per object)
+/// @c FeedDownload reads url, etag, and modified from @c meta and the optional @c regex .
+static inline NSArray<NSString*>* PrefetchDownload(void) { return @[@"meta", @"regex"]; }
+/// @c NSMenu insertFeedGroupItem: reads title, counts, and icon from @c feed .
+static inline NSArray<NSString*>* PrefetchMenuGroup(void) { return @[@"feed"]; }
+/// Batch size of unlimited article lists.
+static NSUInteger const kArticleBatchSize = 50;
+
 @implementation StoreCoordinator
 
 #pragma mark - Managing contexts
@@ -27,6 +43,53 @@
 	return context;
 }
 
+/**
+ New context with @c NSPrivateQueueConcurrencyType attached directly to the persistent store coordinator.
+ Saved changes are merged into the main context automatically. Use @c performBlock: for all operations.
+ */
++ (NSManagedObjectContext*)createBackgroundContext {
+	NSManagedObjectContext *context = [[(AppHook*)NSApp persistentContainer] newBackgroundContext];
+	context.undoManager = nil;
+	context.mergePolicy = NSMergeByPropertyObjectTrumpMergePolicy;
+	return context;
+}
+
+/// Contexts with long living objects (e.g., preferences), refreshed after batch operations. Main context is always refreshed.
+static NSHashTable<NSManagedObjectContext*>* BatchMergeContexts(void) {
+	static NSHashTable *contexts;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		contexts = [NSHashTable weakObjectsHashTable];
+	});
+	return contexts;
+}
+
+/// Refresh objects of @c moc after batch update or batch delete. Context is released automatically (weak reference).
++ (void)registerContextForBatchChanges:(NSManagedObjectContext*)moc {
+	[BatchMergeContexts() addObject:moc];
+}
+
+/**
+ Merge changes of batch requests (which bypass all contexts) into main context and all registered contexts.
+ Undo registration is disabled during merge. Otherwise, the user could undo a change that was never made in preferences.
+ @warning Must be called on main thread. Registered contexts are main queue contexts and the list is not synchronized.
+ 
+ @param changes Dictionary with @c NSUpdatedObjectsKey and / or @c NSDeletedObjectsKey
+ */
++ (void)mergeBatchChanges:(NSDictionary*)changes {
+	NSAssert(NSThread.isMainThread, @"batch changes must be merged on main thread");
+	[NSManagedObjectContext mergeChangesFromRemoteContextSave:changes intoContexts:@[[self getMainContext]]];
+	for (NSManagedObjectContext *moc in BatchMergeContexts()) {
+		[moc performBlockAndWait:^{
+			[moc processPendingChanges];
+			[moc.undoManager disableUndoRegistration];
+			[NSManagedObjectContext mergeChangesFromRemoteContextSave:changes intoContexts:@[moc]];
+			[moc processPendingChanges];
+			[moc.undoManager enableUndoRegistration];
+		}];
+	}
+}
+
 /**
  Commit changes and perform save operation on @c context.
 
@@ -36,8 +99,10 @@
 	if (![context commitEditing])
 		NSLogCaller(@"unable to commit editing before saving");
 	NSError *error = nil;
-	if (context.hasChanges && ![context save:&error])
-		[error inCasePresent:NSApp];
+	if (context.hasChanges && ![context save:&error]) {
+		if (NSThread.isMainThread) [error inCasePresent:NSApp];
+		else dispatch_async(dispatch_get_main_queue(), ^{ [error inCasePresent:NSApp]; });
+	}
 	if (flag && context.parentContext)
 		[self saveContext:context.parentContext andParent:flag];
 }
@@ -82,7 +147,7 @@
  @param moc If @c nil perform requests on main context (ok for reading).
  */
 + (NSArray<Feed*>*)feedsThatNeedUpdate:(nullable NSManagedObjectContext*)moc {
-	NSFetchRequest *fr = [Feed fetchRequest];
+	NSFetchRequest *fr = [[Feed fetchRequest] prefetch:PrefetchDownload()];
 	// when fetching also get those feeds that would need update soon (now + 2s)
 	[fr where:@"meta.scheduled <= %@", [NSDate dateWithTimeIntervalSinceNow:+2]];
 	return [fr fetchAllRows:moc ? moc : [self getMainContext]];
@@ -94,11 +159,49 @@
  @param moc If @c nil perform requests on main context (ok for reading).
  */
 + (NSArray<Feed*>*)feedsWithIndexPath:(nullable NSString*)path inContext:(nullable NSManagedObjectContext*)moc {
-	NSFetchRequest *fr = [Feed fetchRequest];
+	if (!moc) moc = [self getMainContext];
+	NSFetchRequest *fr = [[Feed fetchRequest] prefetch:PrefetchDownload()];
 	if (path && path.length > 0) {
-		[fr where:@"indexPath = %@ OR indexPath BEGINSWITH %@", path, [path stringByAppendingString:@"."]];
+		fr.predicate = [self predicateForSubtree:path keyPath:@"treeIndex" inclusive:YES inContext:moc];
+		if (!fr.predicate)
+			[fr where:@"indexPath = %@ OR indexPath BEGINSWITH %@", path, [path stringByAppendingString:@"."]];
 	}
-	return [fr fetchAllRows:moc ? moc : [self getMainContext]];
+	return [fr fetchAllRows:moc];
+}
+
+/// @return @c FeedGroup at dot separated @c path. Walking down the tree by @c sortIndex (one indexed fetch per level).
++ (nullable FeedGroup*)groupWithIndexPath:(nonnull NSString*)path inContext:(NSManagedObjectContext*)moc {
+	FeedGroup *fg = nil;
+	for (NSString *idx in [path componentsSeparatedByString:@"."]) {
+		fg = [[[FeedGroup fetchRequest] where:@"parent = %@ AND sortIndex = %d", fg, idx.intValue] fetchFirst:moc];
+		if (!fg) return nil;
+	}
+	return fg;
+}
+
+/**
+ Range predicate on nested interval of @c FeedGroup at @c path. E.g., @c "treeIndex > 5 AND treeIndex < 9"
+ Descendants without interval (nesting too deep for their parent) have @c treeIndex @c = @c 0 and are matched by ID instead.
+ 
+ @param key Key path of @c Feed.treeIndex relative to fetched entity. E.g., @c "feed.treeIndex" for @c FeedArticle.
+ @param flag If @c YES the item at @c path itself is included (if it is a @c Feed ).
+ @return @c nil if group does not exist or has no interval (deep nesting). Use @c indexPath string comparison instead.
+ */
++ (nullable NSPredicate*)predicateForSubtree:(nonnull NSString*)path keyPath:(NSString*)key inclusive:(BOOL)flag inContext:(NSManagedObjectContext*)moc {
+	FeedGroup *fg = [self groupWithIndexPath:path inContext:moc];
+	if (![fg hasTreeInterval])
+		return nil;
+	NSPredicate *range = [NSPredicate predicateWithFormat:(flag ? @"%K >= %lld AND %K < %lld" : @"%K > %lld AND %K < %lld"), key, fg.treeLower, key, fg.treeUpper];
+	NSArray<NSManagedObjectID*> *deep = [[[Feed fetchRequest] where:@"treeIndex = 0 AND indexPath BEGINSWITH %@", [path stringByAppendingString:@"."]] fetchIDs:moc];
+	if (deep.count == 0)
+		return range;
+	NSString *rel = ([key isEqualToString:@"treeIndex"] ? @"SELF" : [key stringByDeletingPathExtension]); // "feed.treeIndex" -> "feed"
+	return [NSCompoundPredicate orPredicateWithSubpredicates:@[range, [NSPredicate predicateWithFormat:@"%K IN %@", rel, deep]]];
+}
+
+/// @return @c YES if any @c Feed has no nested interval (e.g., nesting too deep). Sorting by @c treeIndex would move those to the top.
++ (BOOL)hasFeedsWithoutTreeIndex:(NSManagedObjectContext*)moc {
+	return [[[Feed fetchRequest] where:@"treeIndex = 0"] fetchCount:moc] > 0;
 }
 
 
@@ -109,9 +212,11 @@
 	return [[FeedGroup fetchRequest] fetchFirst:[self getMainContext]] == nil;
 }
 
-/// @return Sum of all unread @c FeedArticle items.
+/// @return Sum of all unread @c FeedArticle items. Uses stored @c Feed.unreadCount (no article fetch).
 + (NSUInteger)countTotalUnread {
-	return [[[FeedArticle fetchRequest] where:@"unread = YES"] fetchCount: [self getMainContext]];
+	NSFetchRequest *fr = [Feed fetchRequest];
+	[fr addFunctionExpression:@"sum:" onKeyPath:@"unreadCount" name:@"unread" type:NSInteger64AttributeType];
+	return [[fr fetchFirstDict: [self getMainContext]][@"unread"] unsignedIntegerValue];
 }
 
 /// @return Count of objects at root level. Aka @c sortIndex for the next @c FeedGroup item.
@@ -119,13 +224,9 @@
 	return [[[FeedGroup fetchRequest] where:@"parent = NULL"] fetchCount:moc];
 }
 
-/// @return Unread and total count grouped by @c Feed item.
+/// @return Stored @c unreadCount and @c totalCount for each @c Feed item (with @c indexPath ).
 + (NSArray<NSDictionary*>*)countAggregatedUnread {
-	NSFetchRequest *fr = [Feed fetchRequest];
-	fr.propertiesToGroupBy = @[ @"indexPath" ];
-	fr.propertiesToFetch = @[ @"indexPath" ];
-	[fr addFunctionExpression:@"sum:" onKeyPath:@"articles.unread" name:@"unread" type:NSInteger32AttributeType];
-	[fr addFunctionExpression:@"count:" onKeyPath:@"articles.unread" name:@"total" type:NSInteger32AttributeType];
+	NSFetchRequest *fr = [[Feed fetchRequest] select:@[@"indexPath", @"unreadCount", @"totalCount"]];
 	return (NSArray<NSDictionary*>*)[fr fetchAllRows: [self getMainContext]];
 }
 
@@ -137,13 +238,26 @@
  @return Sorted list of @c FeedGroup items where @c FeedGroup.parent @c = @c parent.
  */
 + (NSArray<FeedGroup*>*)sortedFeedGroupsWithParent:(nullable id)parent inContext:(nullable NSManagedObjectContext*)moc {
-	return [[[[FeedGroup fetchRequest] where:@"parent = %@", parent] sortASC:@"sortIndex"] fetchAllRows:moc ? moc : [self getMainContext]];
+	NSFetchRequest *fr = [[[[FeedGroup fetchRequest] where:@"parent = %@", parent] sortASC:@"sortIndex"] prefetch:PrefetchMenuGroup()];
+	return [fr fetchAllRows:moc ? moc : [self getMainContext]];
 }
 
-/// @return Sorted list of @c FeedArticle items where @c FeedArticle.feed @c = @c parent.
-//+ (NSArray<FeedArticle*>*)sortedArticlesWithParent:(id)parent inContext:(NSManagedObjectContext*)moc {
-//	return [[[[FeedArticle fetchRequest] where:@"feed = %@", parent] sortDESC:@"sortIndex"] fetchAllRows:moc];
-//}
+/**
+ @return Sorted list of @c FeedArticle items where @c FeedArticle.feed @c = @c parent (newest first).
+ @param flag If @c YES return unread articles only.
+ @param limit Max. number of returned articles. @c 0 for unlimited (fetched in batches).
+ */
++ (NSArray<FeedArticle*>*)sortedArticlesWithParent:(Feed*)parent unreadOnly:(BOOL)flag limit:(NSUInteger)limit inContext:(nullable NSManagedObjectContext*)moc {
+	NSFetchRequest<FeedArticle*> *fr = [FeedArticle fetchRequest];
+	if (flag) [fr where:@"feed = %@ AND unread = YES", parent];
+	else      [fr where:@"feed = %@", parent];
+	[fr sortDESC:@"sortIndex"];
+	fr.returnsObjectsAsFaults = NO; // menu items need all attributes anyway
+	fr.fetchLimit = limit;
+	if (limit == 0)
+		fr.fetchBatchSize = kArticleBatchSize;
+	return [fr fetchAllRows:moc ? moc : [self getMainContext]];
+}
 
 /// @return Unsorted list of @c Feed items where @c articles.count @c == @c 0.
 //+ (NSArray<Feed*>*)listOfFeedsMissingArticlesInContext:(NSManagedObjectContext*)moc {
@@ -163,7 +277,7 @@
 	return [[[[Feed fetchRequest] where:@"indexPath = %@", path] select:@[@"link"]] fetchFirstDict: [self getMainContext]][@"link"];
 }
 
-/// @return Unsorted list of object IDs where @c Feed.indexPath begins with @c path @c + @c "."
+/// @return Unsorted list of object IDs where @c Feed.indexPath begins with @c path @c + @c "." (fallback if group has no interval)
 + (NSArray<NSManagedObjectID*>*)feedIDsForIndexPath:(nonnull NSString*)path inContext:(NSManagedObjectContext*)moc {
 	return [[[Feed fetchRequest] where:@"indexPath BEGINSWITH %@", [path stringByAppendingString:@"."]] fetchIDs:moc];
 }
@@ -178,6 +292,10 @@
 		Feed *obj = [self feedWithIndexPath:path inContext:moc];
 		return [NSPredicate predicateWithFormat:@"feed = %@", obj.objectID];
 	}
+	NSPredicate *subtree = [self predicateForSubtree:path keyPath:@"feed.treeIndex" inclusive:NO inContext:moc];
+	if (subtree) {
+		return subtree;
+	}
 	NSArray *list = [self feedIDsForIndexPath:path inContext:moc];
 	if (list && list.count > 0) {
 		return [NSPredicate predicateWithFormat:@"feed IN %@", list];
@@ -199,21 +317,77 @@
 	NSFetchRequest<FeedArticle*> *fr = [[FeedArticle fetchRequest] where:@"unread = %d", readFlag];
 	fr.fetchLimit = limit;
 	if (sortFlag) {
-		if (!path || !feedFlag)
-			[fr sortASC:@"feed.indexPath"];
+		if (!path || !feedFlag) {
+			if (![self hasFeedsWithoutTreeIndex:moc])
+				[fr sortASC:@"feed.treeIndex"]; // same order as menu
+			[fr sortASC:@"feed.indexPath"]; // deep nesting without interval
+		}
 		[fr sortDESC:@"sortIndex"];
 	}
-	/* UNUSED. Batch updates will break NSUndoManager in preferences. Fix that before usage.
-	 NSBatchUpdateRequest *bur = [NSBatchUpdateRequest batchUpdateRequestWithEntityName: FeedArticle.entity.name];
-	 bur.propertiesToUpdate = @{ @"unread": @(!readFlag) };
-	 bur.resultType = NSUpdatedObjectIDsResultType;
-	 bur.predicate = [NSPredicate predicateWithFormat:@"unread = %d", readFlag];*/
 	NSPredicate *feedFilter = [self predicateWithPath:path isFeed:feedFlag inContext:moc];
 	if (feedFilter)
 		fr.predicate = [NSCompoundPredicate andPredicateWithSubpredicates:@[fr.predicate, feedFilter]];
 	return [fr fetchAllRows:moc];
 }
 
+/**
+ Mark all articles at @c path read (or unread) without loading them into memory.
+ Uses @c NSBatchUpdateRequest on @c FeedArticle.unread and @c Feed.unreadCount (all unread articles of a feed are affected).
+ Unread change and notification IDs are calculated from object IDs only. Updated objects are merged into live contexts.
+ 
+ @param path Same as @c articlesAtPath:isFeed:sorted:unread:inContext:limit:
+ @return @c notificationID for all articles (and feeds) that were marked read. Empty if marked unread.
+ */
++ (NSArray<NSString*>*)markAllArticlesAtPath:(nullable NSString*)path isFeed:(BOOL)feedFlag markRead:(BOOL)markRead {
+	NSManagedObjectContext *moc = [self getMainContext];
+	NSPredicate *pred = [NSPredicate predicateWithFormat:@"unread = %d", markRead];
+	NSPredicate *feedFilter = [self predicateWithPath:path isFeed:feedFlag inContext:moc];
+	if (feedFilter)
+		pred = [NSCompoundPredicate andPredicateWithSubpredicates:@[pred, feedFilter]];
+	// affected feeds and number of affected articles per feed
+	NSFetchRequest *fr = [FeedArticle fetchRequest];
+	fr.predicate = pred;
+	fr.propertiesToGroupBy = @[ @"feed" ];
+	fr.propertiesToFetch = @[ @"feed" ];
+	[fr addFunctionExpression:@"count:" onKeyPath:@"unread" name:@"count" type:NSInteger32AttributeType];
+	NSMutableArray<NSManagedObjectID*> *feeds = [NSMutableArray array];
+	NSInteger countChange = 0;
+	for (NSDictionary *d in [fr fetchAllRows:moc]) {
+		if (d[@"feed"]) [feeds addObject:d[@"feed"]];
+		countChange += [d[@"count"] integerValue];
+	}
+	if (countChange == 0)
+		return @[];
+	// gather uri-ids for notification dismiss (before update, otherwise predicate won't match)
+	NSMutableArray<NSString*> *dbRefs = [NSMutableArray array];
+	if (markRead) {
+		NSFetchRequest *ids = [FeedArticle fetchRequest];
+		ids.predicate = pred;
+		for (NSManagedObjectID *oid in [[ids fetchIDs:moc] arrayByAddingObjectsFromArray:feeds])
+			[dbRefs addObject:oid.URIRepresentation.absoluteString]; // same as notificationID
+	}
+	NSMutableArray<NSManagedObjectID*> *updated = [NSMutableArray array];
+	[updated addObjectsFromArray:[self batchUpdate:FeedArticle.entity predicate:pred
+											values:@{ @"unread": @(!markRead) } inContext:moc]];
+	[updated addObjectsFromArray:[self batchUpdate:Feed.entity predicate:[NSPredicate predicateWithFormat:@"self IN %@", feeds]
+											values:@{ @"unreadCount": (markRead ? @0 : [NSExpression expressionForKeyPath:@"totalCount"]) } inContext:moc]];
+	[self mergeBatchChanges:@{ NSUpdatedObjectsKey: updated }];
+	PostNotification(kNotificationTotalUnreadCountChanged, @(markRead ? -countChange : countChange));
+	return dbRefs;
+}
+
+/// Perform @c NSBatchUpdateRequest on @c entity . @return Object IDs of updated rows.
++ (NSArray<NSManagedObjectID*>*)batchUpdate:(NSEntityDescription*)entity predicate:(NSPredicate*)pred values:(NSDictionary*)values inContext:(NSManagedObjectContext*)moc {
+	NSBatchUpdateRequest *bur = [[NSBatchUpdateRequest alloc] initWithEntity:entity];
+	bur.predicate = pred;
+	bur.propertiesToUpdate = values;
+	bur.resultType = NSUpdatedObjectIDsResultType;
+	NSError *err;
+	NSBatchUpdateResult *res = [moc executeRequest:bur error:&err];
+	[err inCaseLog:"Couldn't update batch"];
+	return res.result ?: @[];
+}
+
 /**
  For provided articles, pen link, mark read, and save changes.
  @warning Will invalidate context.
@@ -239,6 +413,7 @@
 	for (FeedArticle *fa in list) {
 		if (fa.unread == markRead) { // only if differs
 			fa.unread = !markRead;
+			[fa.feed addUnreadCount:markRead ? -1 : +1];
 			countChange += markRead ? -1 : +1;
 		}
 	}
@@ -265,26 +440,127 @@
 + (void)cleanupAndShowAlert:(BOOL)flag {
 	NSUInteger deleted = [self deleteUnreferenced];
 	[self restoreFeedIndexPaths];
+	NSUInteger pruned = [self pruneArticlesInContext:[self getMainContext]];
+	NSUInteger repaired = [self restoreFeedCounts];
 	PostNotification(kNotificationTotalUnreadCountReset, nil);
 	if (flag) {
+		NSString *msg = [NSString stringWithFormat:NSLocalizedString(@"Removed %lu unreferenced database entries.", nil), deleted];
+		if (pruned > 0)
+			msg = [msg stringByAppendingFormat:@"\n%@", [NSString stringWithFormat:NSLocalizedString(@"Pruned %lu articles exceeding retention limits.", nil), pruned]];
+		if (repaired > 0)
+			msg = [msg stringByAppendingFormat:@"\n%@", [NSString stringWithFormat:NSLocalizedString(@"Repaired article count of %lu feeds.", nil), repaired]];
 		NSAlert *alert = [[NSAlert alloc] init];
 		alert.messageText = NSLocalizedString(@"Database cleanup successful", nil);
-		alert.informativeText = [NSString stringWithFormat:NSLocalizedString(@"Removed %lu unreferenced database entries.", nil), deleted];
+		alert.informativeText = msg;
 		alert.alertStyle = NSAlertStyleInformational;
 		[alert runModal];
 	}
 }
 
-/// Iterate over all @c Feed and re-calculate @c indexPath.
+/// Iterate over all @c FeedGroup and re-calculate nested interval. Also re-calculate @c indexPath of all @c Feed.
 + (void)restoreFeedIndexPaths {
 	NSManagedObjectContext *moc = [self getMainContext];
-	for (Feed *f in [[Feed fetchRequest] fetchAllRows:moc]) {
-		[f calculateAndSetIndexPathString];
+	NSArray<FeedGroup*> *roots = [self sortedFeedGroupsWithParent:nil inContext:moc];
+	for (FeedGroup *fg in roots) {
+		[fg updateTreeInterval:YES siblings:roots.count];
 	}
 	[self saveContext:moc andParent:YES];
 	[moc reset];
 }
 
+/**
+ Count articles of all @c Feed items and compare with stored @c unreadCount and @c totalCount.
+ Mismatching values are overwritten.
+ @return Number of repaired @c Feed items.
+ */
++ (NSUInteger)restoreFeedCounts {
+	NSManagedObjectContext *moc = [self getMainContext];
+	NSFetchRequest *fr = [FeedArticle fetchRequest];
+	fr.propertiesToGroupBy = @[ @"feed" ];
+	fr.propertiesToFetch = @[ @"feed" ];
+	[fr addFunctionExpression:@"sum:" onKeyPath:@"unread" name:@"unread" type:NSInteger32AttributeType];
+	[fr addFunctionExpression:@"count:" onKeyPath:@"unread" name:@"total" type:NSInteger32AttributeType];
+	NSMutableDictionary<NSManagedObjectID*, NSDictionary*> *counts = [NSMutableDictionary dictionary];
+	for (NSDictionary *d in [fr fetchAllRows:moc]) {
+		if (d[@"feed"]) counts[d[@"feed"]] = d;
+	}
+	NSUInteger repaired = 0;
+	for (Feed *f in [[Feed fetchRequest] fetchAllRows:moc]) {
+		NSDictionary *d = counts[f.objectID];
+		int32_t unread = [d[@"unread"] intValue], total = [d[@"total"] intValue]; // nil if feed has no articles
+		if (f.unreadCount != unread || f.totalCount != total) {
+			[f setUnreadCount:unread total:total];
+			repaired += 1;
+		}
+	}
+	if (repaired > 0) {
+		[self saveContext:moc andParent:YES];
+		[moc reset];
+	}
+	return repaired;
+}
+
+/**
+ Delete articles exceeding the retention policy of each @c Feed (max. count and max. age, optionally keep unread).
+ Uses @c NSBatchDeleteRequest , stored counts are @b not updated. Call @c restoreFeedCounts afterwards.
+ Deleted objects are merged into the main context (asynchronously, if called on background queue)
+ and delivered notifications are dismissed.
+ 
+ @param moc Must be called on the queue of @c moc .
+ @return Number of deleted articles.
+ */
++ (NSUInteger)pruneArticlesInContext:(NSManagedObjectContext*)moc {
+	NSFetchRequest *fr = [Feed fetchRequest];
+	fr.relationshipKeyPathsForPrefetching = @[ @"meta" ];
+	NSMutableArray<NSManagedObjectID*> *deleted = [NSMutableArray array];
+	for (Feed *f in [fr fetchAllRows:moc]) {
+		ArticleRetention policy = [f.meta effectiveRetention];
+		NSMutableArray<NSPredicate*> *limits = [NSMutableArray arrayWithCapacity:2];
+		if (policy.maxCount > 0 && (NSUInteger)f.totalCount > policy.maxCount) {
+			// sortIndex of the newest article that is over the limit
+			NSFetchRequest *nth = [[[[FeedArticle fetchRequest] where:@"feed = %@", f] sortDESC:@"sortIndex"] select:@[@"sortIndex"]];
+			nth.fetchOffset = policy.maxCount;
+			NSNumber *idx = [nth fetchFirstDict:moc][@"sortIndex"];
+			if (idx) [limits addObject:[NSPredicate predicateWithFormat:@"sortIndex <= %@", idx]];
+		}
+		if (policy.maxDays > 0) {
+			NSDate *cutoff = [NSDate dateWithTimeIntervalSinceNow:-(NSTimeInterval)policy.maxDays * 24 * 60 * 60];
+			[limits addObject:[NSPredicate predicateWithFormat:@"published < %@", cutoff]];
+		}
+		if (limits.count == 0)
+			continue;
+		NSMutableArray<NSPredicate*> *conditions = [NSMutableArray arrayWithCapacity:3];
+		[conditions addObject:[NSPredicate predicateWithFormat:@"feed = %@", f]];
+		if (policy.keepUnread)
+			[conditions addObject:[NSPredicate predicateWithFormat:@"unread = NO"]];
+		[conditions addObject:[NSCompoundPredicate orPredicateWithSubpredicates:limits]];
+		NSFetchRequest *del = [FeedArticle fetchRequest];
+		del.predicate = [NSCompoundPredicate andPredicateWithSubpredicates:conditions];
+		NSBatchDeleteRequest *bdr = [[NSBatchDeleteRequest alloc] initWithFetchRequest:del];
+		bdr.resultType = NSBatchDeleteResultTypeObjectIDs;
+		NSError *err;
+		NSBatchDeleteResult *res = [moc executeRequest:bdr error:&err];
+		[err inCaseLog:"Couldn't prune articles"];
+		if (res.result) [deleted addObjectsFromArray:res.result];
+	}
+	if (deleted.count == 0)
+		return 0;
+	if (NSThread.isMainThread) {
+		[self mergeBatchChanges:@{ NSDeletedObjectsKey: deleted }];
+	} else {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			[self mergeBatchChanges:@{ NSDeletedObjectsKey: deleted }];
+		});
+	}
+	if (@available(macOS 10.14, *)) {
+		NSMutableArray<NSString*> *dismissed = [NSMutableArray arrayWithCapacity:deleted.count];
+		for (NSManagedObjectID *oid in deleted)
+			[dismissed addObject:oid.URIRepresentation.absoluteString]; // same as FeedArticle.notificationID
+		[NotifyEndpoint dismiss:dismissed];
+	}
+	return deleted.count;
+}
+
 /**
  Delete all @c Feed items where @c group @c = @c NULL and all @c FeedMeta, @c FeedIcon, @c FeedArticle where @c feed @c = @c NULL.
  */
@@ -348,4 +624,186 @@
 	return toBeDeleted.count;
 }
 
+
+#ifdef DEBUG
+#pragma mark - Round-Trip Counter (DEBUG)
+
+static _Atomic(NSUInteger) _fetchCount = 0;
+static _Atomic(NSUInteger) _faultCount = 0;
+
+/// Replace @c sel of @c cls with a wrapper that increments @c counter . Signature: @c (id)method:(id)a :(id)b :(NSError**)c
+static void CountCalls3(Class cls, SEL sel, _Atomic(NSUInteger) *counter) {
+	Method m = class_getInstanceMethod(cls, sel);
+	if (!m) { NSLog(@"round-trip counter: %@ not found", NSStringFromSelector(sel)); return; }
+	id (*original)(id, SEL, id, id, NSError**) = (id (*)(id, SEL, id, id, NSError**))method_getImplementation(m);
+	method_setImplementation(m, imp_implementationWithBlock(^id(id obj, id a, id b, NSError **c) {
+		atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+		return original(obj, sel, a, b, c);
+	}));
+}
+
+/// Same as @c CountCalls3() with signature: @c (id)method:(id)a :(id)b :(id)c :(NSError**)d
+static void CountCalls4(Class cls, SEL sel, _Atomic(NSUInteger) *counter) {
+	Method m = class_getInstanceMethod(cls, sel);
+	if (!m) { NSLog(@"round-trip counter: %@ not found", NSStringFromSelector(sel)); return; }
+	id (*original)(id, SEL, id, id, id, NSError**) = (id (*)(id, SEL, id, id, id, NSError**))method_getImplementation(m);
+	method_setImplementation(m, imp_implementationWithBlock(^id(id obj, id a, id b, id c, NSError **d) {
+		atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+		return original(obj, sel, a, b, c, d);
+	}));
+}
+
+/**
+ Count requests that reach the persistent store coordinator (any context, nested contexts included).
+ Fetch requests are counted separately from fault fulfillment (object and to-many relationship faults).
+ Prefetched relationships are loaded within the fetch and do not increase the fault count.
+ @note Fault fulfillment uses internal methods of @c NSPersistentStoreCoordinator (same names as @c NSIncrementalStore ).
+ */
++ (void)initialize {
+	if (self != [StoreCoordinator class])
+		return;
+	Class psc = [NSPersistentStoreCoordinator class];
+	CountCalls3(psc, @selector(executeRequest:withContext:error:), &_fetchCount);
+	CountCalls3(psc, NSSelectorFromString(@"newValuesForObjectWithID:withContext:error:"), &_faultCount);
+	CountCalls4(psc, NSSelectorFromString(@"newValueForRelationship:forObjectWithID:withContext:error:"), &_faultCount);
+}
+
+/// @return Number of store requests (fetch, batch update, etc.) since app launch. Use the difference of two calls to measure a code section.
++ (NSUInteger)fetchCount { return _fetchCount; }
+
+/// @return Number of faults fulfilled by the store since app launch. Use the difference of two calls to measure a code section.
++ (NSUInteger)faultCount { return _faultCount; }
+
+
+#pragma mark - Query Benchmark (DEBUG)
+
+/// @return New private queue context on an empty in-memory store with the app's model. Used by benchmarks only.
++ (NSManagedObjectContext*)createBenchmarkContext {
+	NSManagedObjectModel *model = [(AppHook*)NSApp persistentContainer].managedObjectModel;
+	NSPersistentStoreCoordinator *psc = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:model];
+	NSError *err;
+	[psc addPersistentStoreWithType:NSInMemoryStoreType configuration:nil URL:nil options:nil error:&err];
+	[err inCaseLog:"Couldn't create benchmark store"];
+	NSManagedObjectContext *moc = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+	moc.persistentStoreCoordinator = psc;
+	moc.undoManager = nil;
+	return moc;
+}
+
+/**
+ Developer tool. Print latency of hot queries on a synthetic store (500 feeds, 1000 articles each).
+ The same store is created twice, once without and once with fetch indexes. Started with @c barss:config/benchmark
+ */
++ (void)benchmarkQueries {
+	NSManagedObjectModel *indexed = [(AppHook*)NSApp persistentContainer].managedObjectModel;
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+		NSManagedObjectModel *plain = [indexed copy];
+		for (NSEntityDescription *entity in plain.entities)
+			entity.indexes = @[];
+		[self benchmarkQueriesWithModel:plain title:"without indexes"];
+		[self benchmarkQueriesWithModel:indexed title:"with indexes"];
+	});
+}
+
+/// Create temporary SQLite store for @c model , fill with synthetic data, and run all queries.
++ (void)benchmarkQueriesWithModel:(NSManagedObjectModel*)model title:(const char*)title {
+	NSURL *url = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:@"benchmark.sqlite"];
+	NSPersistentStoreCoordinator *psc = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:model];
+	[psc destroyPersistentStoreAtURL:url withType:NSSQLiteStoreType options:nil error:nil];
+	NSError *err;
+	[psc addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:url options:nil error:&err];
+	if ([err inCaseLog:"Couldn't create benchmark store"])
+		return;
+	NSManagedObjectContext *moc = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSPrivateQueueConcurrencyType];
+	moc.persistentStoreCoordinator = psc;
+	moc.undoManager = nil;
+	[moc performBlockAndWait:^{
+		[self populateBenchmarkStore:moc groups:50 feeds:10 articles:1000];
+		printf("--- %s ---\n", title);
+		// Feed update
+		benchmark("nextScheduledUpdate", ^{
+			[moc reset];
+			NSFetchRequest *fr = [FeedMeta fetchRequest];
+			[fr addFunctionExpression:@"min:" onKeyPath:@"scheduled" name:@"minDate" type:NSDateAttributeType];
+			[fr fetchFirstDict:moc];
+		});
+		benchmark("feedsThatNeedUpdate", ^{ [moc reset]; [self feedsThatNeedUpdate:moc]; });
+		benchmark("feedsWithIndexPath (group)", ^{ [moc reset]; [self feedsWithIndexPath:@"25" inContext:moc]; });
+		benchmark("feedIDsForIndexPath (BEGINSWITH)", ^{ [moc reset]; [self feedIDsForIndexPath:@"25" inContext:moc]; });
+		benchmark("feedWithIndexPath", ^{ [moc reset]; [self feedWithIndexPath:@"25.5" inContext:moc]; });
+		// Count elements
+		benchmark("countTotalUnread", ^{
+			[moc reset];
+			NSFetchRequest *fr = [Feed fetchRequest];
+			[fr addFunctionExpression:@"sum:" onKeyPath:@"unreadCount" name:@"unread" type:NSInteger64AttributeType];
+			[fr fetchFirstDict:moc];
+		});
+		benchmark("count unread articles (v1.6)", ^{ [moc reset]; [[[FeedArticle fetchRequest] where:@"unread = YES"] fetchCount:moc]; });
+		benchmark("countAggregatedUnread", ^{ [moc reset]; [[[Feed fetchRequest] select:@[@"indexPath", @"unreadCount", @"totalCount"]] fetchAllRows:moc]; });
+		benchmark("sortedFeedGroupsWithParent", ^{ [moc reset]; [self sortedFeedGroupsWithParent:nil inContext:moc]; });
+		// Unread articles
+		benchmark("articlesAtPath (all, sorted)", ^{ [moc reset]; [self articlesAtPath:nil isFeed:NO sorted:YES unread:YES inContext:moc limit:50]; });
+		benchmark("articlesAtPath (group, sorted)", ^{ [moc reset]; [self articlesAtPath:@"25" isFeed:NO sorted:YES unread:YES inContext:moc limit:50]; });
+		benchmark("articlesAtPath (feed, sorted)", ^{ [moc reset]; [self articlesAtPath:@"25.5" isFeed:YES sorted:YES unread:YES inContext:moc limit:0]; });
+		benchmark("articlesAtPath (all, read)", ^{ [moc reset]; [self articlesAtPath:nil isFeed:NO sorted:NO unread:NO inContext:moc limit:0]; });
+		// Restore sound state
+		benchmark("restoreFeedCounts (group by)", ^{
+			[moc reset];
+			NSFetchRequest *fr = [FeedArticle fetchRequest];
+			fr.propertiesToGroupBy = @[ @"feed" ];
+			fr.propertiesToFetch = @[ @"feed" ];
+			[fr addFunctionExpression:@"sum:" onKeyPath:@"unread" name:@"unread" type:NSInteger32AttributeType];
+			[fr addFunctionExpression:@"count:" onKeyPath:@"unread" name:@"total" type:NSInteger32AttributeType];
+			[fr fetchAllRows:moc];
+		});
+		[moc reset];
+	}];
+	[psc destroyPersistentStoreAtURL:url withType:NSSQLiteStoreType options:nil error:nil];
+}
+
+/// Insert @c groups × @c feeds feeds with @c articles articles each. Every 10th article is unread.
++ (void)populateBenchmarkStore:(NSManagedObjectContext*)moc groups:(int32_t)groups feeds:(int32_t)feeds articles:(int32_t)articles {
+	NSEntityDescription *eGroup = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[@"FeedGroup"];
+	NSEntityDescription *eFeed = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[@"Feed"];
+	NSEntityDescription *eMeta = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[@"FeedMeta"];
+	NSEntityDescription *eArticle = moc.persistentStoreCoordinator.managedObjectModel.entitiesByName[@"FeedArticle"];
+	NSDate *now = [NSDate date];
+	for (int32_t g = 0; g < groups; g++) {
+		FeedGroup *parent = [[FeedGroup alloc] initWithEntity:eGroup insertIntoManagedObjectContext:moc];
+		parent.type = GROUP;
+		parent.sortIndex = g;
+		parent.name = [NSString stringWithFormat:@"Group %d", g];
+		for (int32_t f = 0; f < feeds; f++) {
+			FeedGroup *fg = [[FeedGroup alloc] initWithEntity:eGroup insertIntoManagedObjectContext:moc];
+			fg.type = FEED;
+			fg.sortIndex = f;
+			fg.parent = parent;
+			Feed *feed = [[Feed alloc] initWithEntity:eFeed insertIntoManagedObjectContext:moc];
+			feed.group = fg;
+			feed.indexPath = [NSString stringWithFormat:@"%d.%d", g, f];
+			feed.meta = [[FeedMeta alloc] initWithEntity:eMeta insertIntoManagedObjectContext:moc];
+			feed.meta.scheduled = [now dateByAddingTimeInterval:(g * feeds + f) * 60];
+			for (int32_t a = 0; a < articles; a++) {
+				FeedArticle *fa = [[FeedArticle alloc] initWithEntity:eArticle insertIntoManagedObjectContext:moc];
+				fa.feed = feed;
+				fa.sortIndex = a;
+				fa.unread = (a % 10 == 0);
+				fa.published = [now dateByAddingTimeInterval:-a * 60 * 60];
+				fa.link = [NSString stringWithFormat:@"https://example.org/%d/%d/%d", g, f, a];
+			}
+			[feed setUnreadCount:(articles + 9) / 10 total:articles];
+		}
+		NSError *err;
+		[moc save:&err];
+		[err inCaseLog:"Couldn't save benchmark store"];
+		[moc reset];
+	}
+	NSArray<FeedGroup*> *roots = [self sortedFeedGroupsWithParent:nil inContext:moc];
+	for (FeedGroup *fg in roots)
+		[fg updateTreeInterval:YES siblings:roots.count];
+	[moc save:nil];
+	[moc reset];
+}
+#endif
+
 @end
@@ -17,6 +17,10 @@ typedef void(^FaviconDownloadBlock)(NSImage * _Nullable img, NSURL * _Nullable p
 - (void)cancel;
 // Extract from HTML metadata
 + (nullable NSString*)urlForMetadata:(nullable RSHTMLMetadata*)meta;
+// Statistics
++ (int64_t)bytesSaved;
+// Normalize image
++ (nullable NSImage*)iconWithData:(nullable NSData*)data;
 @end
 
 
@@ -5,6 +5,13 @@
 #import "NSURL+Ext.h"
 #import "NSURLRequest+Ext.h"
 
+#include <stdatomic.h>
+
+/// Stop HTML download after this many bytes, even if @c </head> wasn't found yet.
+static NSUInteger const kHeadByteBudget = 256 * 1024;
+/// Sum of bytes not downloaded because the transfer was stopped after @c </head> (only if content length is known).
+static _Atomic(int64_t) _bytesSaved = 0;
+
 @interface FaviconDownload()
 @property (nonatomic, weak) id<FaviconDownloadDelegate> delegate;
 @property (nonatomic, strong) FaviconDownloadBlock block;
@@ -23,6 +30,9 @@
 // |  MARK: - Class methods
 //  ---------------------------------------------------------------
 
+/// Total number of bytes saved by stopping HTML downloads early.
++ (int64_t)bytesSaved { return _bytesSaved; }
+
 /**
  Start favicon download request on existing @c Feed object.
  @note Will post a @c kNotificationFeedIconUpdated notification on success.
@@ -89,11 +99,27 @@
 	if (self.canceled)
 		return;
 	self.remoteURL = nil;
-	self.currentDownload = [[NSURLRequest requestWithURL:self.hostURL] dataTask:^(NSData * _Nullable htmlData, NSError * _Nullable error, NSHTTPURLResponse *response) {
+	__block NSUInteger scanned = 0;
+	BOOL(^stopAfterHead)(NSData*) = ^BOOL(NSData *received) {
+		if (self.canceled || received.length >= kHeadByteBudget)
+			return YES;
+		// rescan a few bytes in case the tag was split between two chunks
+		NSUInteger offset = (scanned > 6 ? scanned - 6 : 0);
+		scanned = received.length;
+		return HasHeadEnd((const char*)received.bytes + offset, received.length - offset);
+	};
+	self.currentDownload = [[NSURLRequest requestWithURL:self.hostURL] streamTask:stopAfterHead finally:^(NSData * _Nullable htmlData, NSError * _Nullable error, NSHTTPURLResponse *response) {
 		if (self.canceled)
 			return;
+		int64_t expected = self.currentDownload.countOfBytesExpectedToReceive;
+		int64_t received = self.currentDownload.countOfBytesReceived;
+		if (expected > received) {
+			atomic_fetch_add(&_bytesSaved, expected - received);
+#if DEBUG && ENV_LOG_DOWNLOAD
+			printf("HEAD %lld of %lld bytes %s\n", received, expected, self.hostURL.absoluteString.UTF8String);
+#endif
+		}
 		if (htmlData) {
-			// TODO: use session delegate to stop download after <head>
 			RSXMLData *xml = [[RSXMLData alloc] initWithData:htmlData url:response.URL];
 			RSHTMLMetadataParser *parser = [RSHTMLMetadataParser parserWithXMLData:xml];
 			RSHTMLMetadata *meta = [parser parseSync:&error];
@@ -105,6 +131,19 @@
 	}];
 }
 
+/// @return @c YES if @c bytes contain either @c </head> or @c <body (case insensitive).
+static BOOL HasHeadEnd(const char *bytes, NSUInteger len) {
+	for (NSUInteger i = 0; i + 5 <= len; i++) {
+		if (bytes[i] != '<')
+			continue;
+		if (i + 6 <= len && strncasecmp(bytes + i, "</head", 6) == 0)
+			return YES;
+		if (strncasecmp(bytes + i, "<body", 5) == 0)
+			return YES;
+	}
+	return NO;
+}
+
 /// Choose action based on whether @c .remoteURL is set.
 - (void)continueWithImageDownload {
 	if (self.canceled)
@@ -125,18 +164,17 @@
 		return;
 	self.currentDownload = [[NSURLRequest requestWithURL:self.remoteURL] downloadTask:^(NSURL * _Nullable path, NSError * _Nullable error) {
 		if (error) path = nil; // will also nullify img
-		NSImage *img;
+		NSImage *img = nil;
 		if (path) {
-			NSData* data = [[NSData alloc] initWithContentsOfURL:path];
-			img = [[NSImage alloc] initWithData:data];
-		} else {
-			img = nil;
+			img = [FaviconDownload iconWithData:[[NSData alloc] initWithContentsOfURL:path]];
 		}
-		if (img.valid) {
-			// move image to temporary destination, otherwise dataTask: will delete it.
+		if (img) {
+			// store scaled image at temporary destination, otherwise dataTask: will delete it.
 			NSString *tmpFile = NSProcessInfo.processInfo.globallyUniqueString;
 			self.fileURL = [[path URLByDeletingLastPathComponent] file:tmpFile ext:nil];
-			[path moveTo:self.fileURL];
+			NSData *tiff = [NSBitmapImageRep TIFFRepresentationOfImageRepsInArray:img.representations usingCompression:NSTIFFCompressionLZW factor:0];
+			if (![tiff writeToURL:self.fileURL atomically:YES])
+				[path moveTo:self.fileURL]; // fallback: keep original image
 		} else if (self.hostURL) {
 			[self loadImageFromDefaultLocation]; // starts a new request
 			return;
@@ -207,4 +245,36 @@ static double ScoreIcon(RSHTMLMetadataIconLink *icon) {
 	return fabs(match) + (match < 0 ? 1e-5 : 0); // slightly prefer larger icons (64px over 16px)
 }
 
+//  ---------------------------------------------------------------
+// |  MARK: - Normalize image
+//  ---------------------------------------------------------------
+
+/**
+ Decode image and downscale to @c 16x16pt with two bitmaps: @c 16px ( @c 1x ) and @c 32px ( @c 2x ).
+ Large favicons (e.g., @c 512px apple-touch-icon) are never stored or kept in memory.
+ @return @c nil if image is not valid.
+ */
++ (nullable NSImage*)iconWithData:(nullable NSData*)data {
+	NSImage *src = data ? [[NSImage alloc] initWithData:data] : nil;
+	if (!src.valid)
+		return nil;
+	NSImage *img = [[NSImage alloc] initWithSize:NSMakeSize(16, 16)];
+	[img addRepresentation:ScaledBitmap(src, 16)];
+	[img addRepresentation:ScaledBitmap(src, 32)];
+	return img;
+}
+
+/// Draw @c img into a new bitmap with @c px width and height. Point size of the bitmap is always @c 16x16.
+static NSBitmapImageRep* ScaledBitmap(NSImage *img, NSInteger px) {
+	NSBitmapImageRep *rep = [[NSBitmapImageRep alloc] initWithBitmapDataPlanes:NULL pixelsWide:px pixelsHigh:px bitsPerSample:8 samplesPerPixel:4 hasAlpha:YES isPlanar:NO colorSpaceName:NSCalibratedRGBColorSpace bytesPerRow:0 bitsPerPixel:0];
+	[NSGraphicsContext saveGraphicsState];
+	NSGraphicsContext *ctx = [NSGraphicsContext graphicsContextWithBitmapImageRep:rep];
+	ctx.imageInterpolation = NSImageInterpolationHigh;
+	NSGraphicsContext.currentContext = ctx;
+	[img drawInRect:NSMakeRect(0, 0, px, px) fromRect:NSZeroRect operation:NSCompositingOperationCopy fraction:1.0];
+	[NSGraphicsContext restoreGraphicsState];
+	rep.size = NSMakeSize(16, 16);
+	return rep;
+}
+
 @end
@@ -1,5 +1,5 @@
 @import Cocoa;
-@class RSParsedFeed, RSHTMLMetadataFeedLink, Feed, FaviconDownload, RegexConverter;
+@class RSParsedFeed, RSHTMLMetadataFeedLink, Feed, FaviconDownload, RegexConverter, FeedUpdateMetrics;
 @protocol FeedDownloadDelegate;
 
 NS_ASSUME_NONNULL_BEGIN
@@ -15,6 +15,10 @@ NS_ASSUME_NONNULL_BEGIN
 @property (readonly, nullable) NSError *error;
 @property (readonly, nullable) NSString *faviconURL;
 @property (readonly, nullable) NSData *rawData;
+/// @c YES if server responded with the same payload as last time (handled like status code @c 304 ).
+@property (readonly) BOOL unchanged;
+/// Timeline of download, parse, and reconcile stages. Save stage is added by the caller.
+@property (readonly, nullable) FeedUpdateMetrics *metrics;
 
 typedef void (^FeedDownloadBlock)(FeedDownload *sender);
 
@@ -23,10 +27,12 @@ typedef void (^FeedDownloadBlock)(FeedDownload *sender);
 + (instancetype)withFeed:(Feed*)feed forced:(BOOL)flag;
 // Actions
 - (instancetype)withRegex:(nullable RegexConverter *)converter enforce:(BOOL)flag;
+- (instancetype)withArticleLimit:(NSUInteger)limit;
 - (instancetype)startWithDelegate:(id<FeedDownloadDelegate>)delegate;
 - (instancetype)startWithBlock:(nonnull FeedDownloadBlock)block;
 - (void)cancel;
 - (BOOL)copyValuesTo:(nonnull Feed*)feed ignoreError:(BOOL)flag;
+- (BOOL)copyValuesTo:(nonnull Feed*)feed ignoreError:(BOOL)flag unreadDiff:(nullable NSInteger*)diff;
 // Getter
 - (FaviconDownload*)faviconDownload;
 @end
@@ -8,7 +8,115 @@
 #import "NSURLRequest+Ext.h"
 #import "RegexFeed.h"
 #import "RegexConverter+Ext.h"
+#import "UpdateMetrics.h"
+#import "Constants.h"
+#import "UserPrefs.h"
 
+/// Max number of feeds parsed simultaneously (bounded parse stage).
+static long const kMaxConcurrentParse = 2;
+static dispatch_queue_t _parseAdmission;
+static dispatch_semaphore_t _parseSlots;
+
+/// Run @c block on a concurrent queue once a parse slot is available. Caller must call @c ParseStageDone() after parsing.
+static void ParseStageEnqueue(os_block_t block) {
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		_parseAdmission = dispatch_queue_create("de.relikd.baRSS.parse", DISPATCH_QUEUE_SERIAL);
+		_parseSlots = dispatch_semaphore_create(kMaxConcurrentParse);
+	});
+	dispatch_async(_parseAdmission, ^{
+		dispatch_semaphore_wait(_parseSlots, DISPATCH_TIME_FOREVER); // FIFO, blocks admission queue only
+		dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), block); // long-running regex must not block admission
+	});
+}
+
+/// Release parse slot. Must be called exactly once for every @c ParseStageEnqueue() call.
+static void ParseStageDone(void) {
+	dispatch_semaphore_signal(_parseSlots);
+}
+
+/// FNV-1a hash over raw response bytes. @return @c 0 is reserved for "no digest".
+static int64_t PayloadDigest(NSData *data) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	const uint8_t *bytes = data.bytes;
+	for (NSUInteger i = 0; i < data.length; i++)
+		hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+	return (int64_t)(hash ? hash : 1);
+}
+
+/**
+ @return Position after the @c limit -th @c </item> or @c </entry> tag. Scanning starts at @c *scanned (updated on return).
+ Tags inside @c CDATA sections are ignored. An unterminated section is rescanned once more data is available.
+ */
+static NSUInteger FindArticleLimit(NSData *data, NSUInteger limit, NSUInteger *scanned, NSUInteger *found) {
+	const char *bytes = data.bytes;
+	NSUInteger len = data.length, i = *scanned;
+	for (; i + 8 <= len; i++) { // "</entry>" is 8 bytes long, shorter tags are checked with the next chunk
+		if (bytes[i] != '<')
+			continue;
+		if (bytes[i+1] == '!') {
+			if (i + 9 > len) break; // "<![CDATA[" is 9 bytes long
+			if (memcmp(bytes + i + 2, "[CDATA[", 7) != 0) continue;
+			const char *end = memmem(bytes + i + 9, len - i - 9, "]]>", 3);
+			if (!end) break; // wait for end of section
+			i = (NSUInteger)(end - bytes) + 2;
+			continue;
+		}
+		if (bytes[i+1] != '/')
+			continue;
+		NSUInteger tagLen = 0;
+		if (memcmp(bytes + i + 2, "item>", 5) == 0) tagLen = 7;
+		else if (memcmp(bytes + i + 2, "entry>", 6) == 0) tagLen = 8;
+		if (tagLen > 0 && ++(*found) >= limit) {
+			*scanned = i + tagLen;
+			return i + tagLen;
+		}
+	}
+	*scanned = i;
+	return 0;
+}
+
+/// @return Position after @c terminator or @c len if not found.
+static NSUInteger SkipPast(const char *bytes, NSUInteger i, NSUInteger len, const char *terminator) {
+	const char *end = memmem(bytes + i, len - i, terminator, strlen(terminator));
+	return end ? (NSUInteger)(end - bytes) + strlen(terminator) : len;
+}
+
+/// @return Qualified name of the root element (e.g., @c rss, @c feed, @c rdf:RDF ). Skips XML declaration, comments and doctype.
+static NSString* RootElementName(NSData *data, NSUInteger length) {
+	const char *bytes = data.bytes;
+	NSUInteger len = MIN(length, 4096u), i = 0; // root element is somewhere near the start
+	while (i < len) {
+		if (bytes[i] != '<') { ++i; continue; } // whitespace, BOM
+		if (i + 1 >= len) break;
+		if (bytes[i+1] == '?') { i = SkipPast(bytes, i, len, "?>"); continue; }
+		if (bytes[i+1] == '!') {
+			if (i + 4 <= len && memcmp(bytes + i, "<!--", 4) == 0) { i = SkipPast(bytes, i, len, "-->"); continue; }
+			// <!DOCTYPE …> with optional internal subset [ … ]
+			NSUInteger close = SkipPast(bytes, i, len, ">");
+			const char *subset = memchr(bytes + i, '[', close - i);
+			i = subset ? SkipPast(bytes, (NSUInteger)(subset - bytes), len, "]>") : close;
+			continue;
+		}
+		NSUInteger start = ++i;
+		while (i < len && !isspace(bytes[i]) && bytes[i] != '>' && bytes[i] != '/')
+			++i;
+		if (i >= len || i == start) break; // name may continue in the next chunk
+		return [[NSString alloc] initWithBytes:bytes + start length:i - start encoding:NSUTF8StringEncoding];
+	}
+	return nil;
+}
+
+/// Cut @c data at @c length and append closing tags for the root element (Atom, RSS 1.0, or RSS 2.0).
+static NSData* CloseTruncatedFeed(NSData *data, NSUInteger length) {
+	NSMutableData *result = [[data subdataWithRange:NSMakeRange(0, length)] mutableCopy];
+	NSString *root = RootElementName(data, length) ?: @"rss";
+	NSString *close = [NSString stringWithFormat:@"</%@>", root]; // Atom and RSS 1.0 items are direct children
+	if ([root isEqualToString:@"rss"] || [root hasSuffix:@":rss"])
+		close = [@"</channel>" stringByAppendingString:close];
+	[result appendData:[close dataUsingEncoding:NSUTF8StringEncoding]];
+	return result;
+}
 
 @interface FeedDownload()
 @property (nonatomic, assign) BOOL respondToSelectFeed, respondToRedirect, respondToEnd;
@@ -24,8 +132,13 @@
 @property (nonatomic, strong) NSError *error;
 @property (nonatomic, strong) NSString *faviconURL;
 @property (nonatomic, strong) NSData *rawData;
+@property (nonatomic, assign) int64_t lastDigest; // skip parsing if payload didn't change
+@property (nonatomic, assign) int64_t payloadDigest;
+@property (nonatomic, assign) BOOL unchanged;
 @property (nonatomic, strong) RegexConverter *regexConverter;
 @property (nonatomic, assign) BOOL regexEnforce;
+@property (nonatomic, assign) NSUInteger articleLimit; // stop download after X articles (0 = no limit)
+@property (nonatomic, strong) FeedUpdateMetrics *metrics;
 @end
 
 @implementation FeedDownload
@@ -38,16 +151,16 @@
 + (instancetype)withURL:(NSString*)url {
 	FeedDownload *this = [FeedDownload new];
 	this.request = [NSURLRequest withURL:url];
-	return this;
+	return [this withArticleLimit:UserPrefsUInt(Pref_feedArticleLimit)];
 }
 
-/// @return New instance using existing @c feed as template. Will reuse @c Etag and @c Last-modified headers.
+/// @return New instance using existing @c feed as template. Will reuse @c Etag and @c Last-modified headers and payload digest.
 + (instancetype)withFeed:(Feed*)feed forced:(BOOL)flag {
 	FeedMeta *m = feed.meta;
 	NSMutableURLRequest *req = [NSMutableURLRequest withURL:m.url];
 	if (!flag) // any request that is not forced, is a background update
 		req.networkServiceType = NSURLNetworkServiceTypeBackground;
-	if (feed.articles.count > 0) { // dont use cache if feed is broken
+	if (feed.totalCount > 0) { // dont use cache if feed is broken
 		// Both fields should be send (if server provides both) RFC: https://tools.ietf.org/html/rfc7232#section-2.4
 		if (m.etag.length > 0)
 			[req setValue:[m.etag stringByReplacingOccurrencesOfString:@"-gzip" withString:@""] forHTTPHeaderField:@"If-None-Match"]; // ETag
@@ -57,6 +170,10 @@
 	FeedDownload *this = [FeedDownload new];
 	this.assertIsFeedURL = YES;
 	this.request = req;
+	this.metrics = [FeedUpdateMetrics withURL:m.url ?: @""]; // same key as in UpdateMetrics summaryForFeed:
+	if (!flag && feed.totalCount > 0) // forced updates will always parse (e.g., after editing regex)
+		this.lastDigest = m.digest;
+	[this withArticleLimit:UserPrefsUInt(Pref_feedArticleLimit)];
 	return [this withRegex:feed.regex enforce:false];
 }
 
@@ -71,6 +188,16 @@
 	return self;
 }
 
+/**
+ Stop download as soon as @c limit articles are received. The truncated document is closed and parsed as usual.
+ Memory usage is bounded by the size of the first @c limit articles. Not used for regex feeds.
+ @param limit Number of articles or @c 0 to download the complete feed.
+ */
+- (instancetype)withArticleLimit:(NSUInteger)limit {
+	self.articleLimit = limit;
+	return self;
+}
+
 /// Set delegate and check what methods are implemented.
 - (void)setDelegate:(id<FeedDownloadDelegate>)observer {
 	_delegate = observer;
@@ -120,9 +247,23 @@
  
  @param flag If @c YES then @c FeedGroup won't increase the error count for the feed.
  Feed will be scheduled as soon as the user reconnects to the internet.
- @return @c YES if downloaded feed contains at least one article. ( @c 304 returns @c NO )
+ @return @c YES if downloaded feed contains at least one article. ( @c 304 and unchanged payload return @c NO )
  */
 - (BOOL)copyValuesTo:(nonnull Feed*)feed ignoreError:(BOOL)flag {
+	NSInteger diff = 0;
+	BOOL updated = [self copyValuesTo:feed ignoreError:flag unreadDiff:&diff];
+	if (diff != 0)
+		PostNotification(kNotificationTotalUnreadCountChanged, @(diff));
+	return updated;
+}
+
+/**
+ Same as @c copyValuesTo:ignoreError: but will not post a @c kNotificationTotalUnreadCountChanged notification.
+ Can be used on a background context. Caller is responsible to post the unread count change on main thread.
+ 
+ @param diff Relative unread count change (inserted minus deleted unread articles).
+ */
+- (BOOL)copyValuesTo:(nonnull Feed*)feed ignoreError:(BOOL)flag unreadDiff:(nullable NSInteger*)diff {
 	if (!flag && self.error) // Increase error count and schedule next update.
 		[feed.meta setErrorAndPostponeSchedule];
 	else if (self.response) // Update Etag & Last modified and schedule next update.
@@ -134,7 +275,14 @@
 	if (!self.xmlfeed || self.xmlfeed.articles.count == 0)
 		return NO;
 	// Else: Update stored articles and indicate that feed was updated
-	[feed updateWithRSS:self.xmlfeed postUnreadCountChange:YES];
+	[self.metrics begin:UpdateStageReconcile];
+	ArticleReconcileCount count = [feed updateWithRSS:self.xmlfeed postUnreadCountChange:NO];
+	if (diff) *diff = count.unreadDiff;
+	if (feed.meta.digest != self.payloadDigest)
+		feed.meta.digest = self.payloadDigest;
+	if (feed.meta.refresh == kFeedRefreshAuto)
+		[feed.meta learnRefreshFromDates:[feed publishedDates]];
+	[self.metrics end:UpdateStageReconcile];
 	return YES;
 }
 
@@ -144,32 +292,73 @@
 
 /// Take the @c urlStr and run a download @c dataTask: on it. Auto-detect if data is HTML or feed.
 - (void)downloadSource:(NSURLRequest*)request {
-	self.currentDownload = [request dataTask:^(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response) {
+	if (!self.metrics)
+		self.metrics = [FeedUpdateMetrics withURL:request.URL.absoluteString];
+	FeedUpdateMetrics *metrics = self.metrics;
+	[metrics begin:UpdateStageDownload];
+	void(^handler)(NSData*, NSError*, NSHTTPURLResponse*) = ^(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response) {
+		[metrics end:UpdateStageDownload];
+		metrics.statusCode = response.statusCode;
+		if (metrics.bytes == 0) // if not reported by task metrics
+			metrics.bytes = (int64_t)data.length;
 		self.error = error;
 		self.response = response;
 		self.rawData = data;
 		if (!data) { // data = nil if (error || 304)
+			metrics.unchanged = (!error);
+			[self performSelectorOnMainThread:@selector(finishAndNotify) withObject:nil waitUntilDone:NO];
+			return;
+		}
+		// server ignored conditional request but payload is identical, handle like 304
+		self.payloadDigest = PayloadDigest(data);
+		if (self.lastDigest != 0 && self.payloadDigest == self.lastDigest) {
+			self.unchanged = YES;
+			metrics.unchanged = YES;
 			[self performSelectorOnMainThread:@selector(finishAndNotify) withObject:nil waitUntilDone:NO];
 			return;
 		}
 		// if regex is used, no further processing
 		if (self.regexConverter || self.regexEnforce) {
-			[self processWithRegexConverter:self.regexConverter data:data];
+			ParseStageEnqueue(^{
+				[self processWithRegexConverter:self.regexConverter data:data];
+				ParseStageDone();
+			});
 			return;
 		}
 		RSXMLData *xml = [[RSXMLData alloc] initWithData:data url:response.URL];
 		if (!self.assertIsFeedURL && [xml.parserClass isHTMLParser])
 			[self processXMLDataHTML:xml]; // HTML source handling
 		else
-			[self processXMLDataFeed:xml]; // XML source handling
+			ParseStageEnqueue(^{ [self processXMLDataFeed:xml]; }); // XML source handling
+	};
+	void(^collect)(NSURLSessionTaskMetrics*) = ^(NSURLSessionTaskMetrics *m) {
+		[metrics setTaskMetrics:m];
+	};
+	if (self.articleLimit == 0 || self.regexConverter || self.regexEnforce) {
+		// streaming session is used for complete downloads too, because it reports task metrics
+		self.currentDownload = [request streamTask:^BOOL(NSData *received) { return NO; } metrics:collect finally:handler];
+		return;
+	}
+	// Stream data and stop after X articles
+	NSUInteger limit = self.articleLimit;
+	__block NSUInteger scanned = 0, found = 0, cut = 0;
+	self.currentDownload = [request streamTask:^BOOL(NSData *received) {
+		cut = FindArticleLimit(received, limit, &scanned, &found);
+		return self.canceled || cut > 0;
+	} metrics:collect finally:^(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response) {
+		if (data && cut > 0 && cut <= data.length)
+			data = CloseTruncatedFeed(data, cut);
+		handler(data, error, response);
 	}];
 }
 
 /// The downloaded source is HTML data and will be parsed with @c RegexConverter
 - (void)processWithRegexConverter:(RegexConverter *)converter data:(NSData *)rawData {
+	[self.metrics begin:UpdateStageParse];
 	NSError *err = nil;
 	if (converter) {
 		NSString *theData = [[NSString alloc] initWithData:rawData encoding:NSUTF8StringEncoding];
+		// default time budget applies, a runaway pattern returns no entries and sets err
 		NSArray<RegexFeedEntry*> *matches = [[RegexFeed from:converter] process:theData error:&err];
 		
 		RSParsedFeed *feed = [[RSParsedFeed alloc] initWithURL:self.request.URL];
@@ -186,6 +375,7 @@
 		self.xmlfeed = nil;
 	}
 	self.error = err;
+	[self.metrics end:UpdateStageParse];
 	[self performSelectorOnMainThread:@selector(finishAndNotify) withObject:nil waitUntilDone:NO];
 }
 
@@ -228,10 +418,14 @@
 //  ---------------------------------------------------------------
 
 /// The downloaded source seems to be proper feed data, lets parse it with @c RSXML @c RSFeedParser
+/// @note Must be called from within @c ParseStageEnqueue()
 - (void)processXMLDataFeed:(RSXMLData*)xml {
 	RSFeedParser *parser = [RSFeedParser parserWithXMLData:xml];
 	parser.dontStopOnLowerAsciiBytes = YES;
+	[self.metrics begin:UpdateStageParse];
 	[parser parseAsync:^(RSParsedFeed * _Nullable parsedDocument, NSError * _Nullable error) {
+		[self.metrics end:UpdateStageParse];
+		ParseStageDone();
 		self.error = error;
 		self.xmlfeed = parsedDocument;
 		[self finishAndNotify];
@@ -250,6 +444,7 @@
 - (void)finishAndNotify {
 	if (self.canceled)
 		return;
+	self.metrics.failed = (self.error != nil);
 	[self checkRedirectAndNotify];
 	// notify observer
 	if (self.respondToEnd) [self.delegate feedDownloadDidFinish:self];
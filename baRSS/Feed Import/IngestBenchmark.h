@@ -0,0 +1,29 @@
+@import Cocoa;
+
+#ifdef DEBUG
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Host served by @c FixtureURLProtocol . Top-level domain @c .invalid will never resolve, requests stay offline.
+extern NSString * const kFixtureHost;
+
+/**
+ Local stand-in for a HTTP server. Serves generated RSS, Atom, HTML and OPML documents for @c kFixtureHost .
+ Supports response latency, @c ETag / @c 304 handling and a server error rate. All other hosts are ignored.
+ */
+@interface FixtureURLProtocol : NSURLProtocol
+@end
+
+
+/**
+ Offline ingestion benchmark. Feed list is imported from fixture OPML into a throwaway store.
+ Each round runs download → parse → reconcile → save for all feeds and prints
+ feeds/sec, p50 / p99 per stage, SQLite transactions and memory usage.
+ */
+@interface IngestBenchmark : NSObject
++ (void)runWithParameters:(NSArray<NSString*>*)params;
+@end
+
+NS_ASSUME_NONNULL_END
+
+#endif
@@ -0,0 +1,396 @@
+@import RSXML2;
+#import "IngestBenchmark.h"
+
+#ifdef DEBUG
+
+#import "AppHook.h"
+#import "FeedDownload.h"
+#import "UpdateMetrics.h"
+#import "Feed+Ext.h"
+#import "FeedGroup+Ext.h"
+#import "RegexConverter+Ext.h"
+#import "NSURLRequest+Ext.h"
+#import "NSError+Ext.h"
+#import "NSFetchRequest+Ext.h"
+
+#include <mach/mach.h>
+#include <stdatomic.h>
+
+NSString * const kFixtureHost = @"fixture.invalid";
+
+/// Number of articles per fixture document.
+static int32_t const kFixtureArticles = 25;
+/// Number of new articles if a document changes between rounds.
+static int32_t const kFixtureArticlesPerVersion = 5;
+/// Number of feeds per group in fixture OPML.
+static int32_t const kFixtureGroupSize = 10;
+/// Number of downloaded feeds saved in a single transaction (same as commit window in @c UpdateScheduler ).
+static NSUInteger const kBenchmarkCommitBatch = 20;
+
+/// Fixture server configuration. Written before each round, read on URL loading threads.
+static struct {
+	double latency; // seconds, ±50% jitter
+	double errorRate; // 0–1, respond with status code 503
+	double changeRate; // 0–1, fraction of documents changed per round
+	_Atomic(int32_t) round;
+} _fixture = { 0.03, 0.02, 0.2, 0 };
+
+typedef NS_ENUM(int32_t, FixtureKind) { FixtureRSS, FixtureAtom, FixtureHTML };
+
+/// 60% RSS, 30% Atom, 10% HTML (regex)
+static inline FixtureKind FixtureKindForID(int32_t fid) {
+	int32_t x = fid % 10;
+	return (x < 6) ? FixtureRSS : (x < 9) ? FixtureAtom : FixtureHTML;
+}
+
+/// Deterministic hash in range @c [0,1) . Same input will produce the same document and errors across runs.
+static inline double FixtureHash(int32_t fid, int32_t round, uint32_t salt) {
+	uint32_t h = (uint32_t)fid * 2654435761u ^ (uint32_t)round * 40503u ^ salt * 2246822519u;
+	h ^= h >> 15; h *= 2246822519u; h ^= h >> 13;
+	return (h % 10000) / 10000.0;
+}
+
+/// Document version increases whenever a feed changed in one of the rounds so far.
+static int32_t FixtureVersion(int32_t fid, int32_t round) {
+	int32_t version = 0;
+	for (int32_t r = 1; r <= round; r++) {
+		if (FixtureHash(fid, r, 1) < _fixture.changeRate)
+			version += 1;
+	}
+	return version;
+}
+
+/// RFC 822 date of fixture article (newest article has highest number).
+static NSString* FixtureDate(int32_t article, BOOL iso) {
+	static NSDateFormatter *rfc822 = nil;
+	static NSISO8601DateFormatter *iso8601 = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		rfc822 = [NSDateFormatter new];
+		rfc822.locale = [NSLocale localeWithLocaleIdentifier:@"en_US_POSIX"];
+		rfc822.timeZone = [NSTimeZone timeZoneForSecondsFromGMT:0];
+		rfc822.dateFormat = @"EEE, dd MMM yyyy HH:mm:ss Z";
+		iso8601 = [NSISO8601DateFormatter new];
+	});
+	NSDate *date = [NSDate dateWithTimeIntervalSince1970:1577836800 + article * 3600]; // 2020-01-01
+	@synchronized (rfc822) {
+		return iso ? [iso8601 stringFromDate:date] : [rfc822 stringFromDate:date];
+	}
+}
+
+/// @return RSS, Atom or HTML document with @c kFixtureArticles articles. Article numbers are shifted by @c version .
+static NSData* FixtureDocument(FixtureKind kind, int32_t fid, int32_t version) {
+	NSString *text = @"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua. "
+	@"Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat.";
+	NSMutableString *str = [NSMutableString stringWithCapacity:512 * kFixtureArticles];
+	switch (kind) {
+		case FixtureRSS: [str appendFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<rss version=\"2.0\"><channel><title>Feed %d</title><link>https://%@/%d</link><description>RSS fixture</description>\n", fid, kFixtureHost, fid]; break;
+		case FixtureAtom: [str appendFormat:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<feed xmlns=\"http://www.w3.org/2005/Atom\"><title>Feed %d</title><link href=\"https://%@/%d\"/><subtitle>Atom fixture</subtitle>\n", fid, kFixtureHost, fid]; break;
+		case FixtureHTML: [str appendFormat:@"<!DOCTYPE html>\n<html><head><title>Feed %d</title></head><body>\n", fid]; break;
+	}
+	int32_t newest = version * kFixtureArticlesPerVersion + kFixtureArticles;
+	for (int32_t a = newest; a > newest - kFixtureArticles; a--) {
+		switch (kind) {
+			case FixtureRSS: [str appendFormat:@"<item><title>Article %d.%d</title><link>https://%@/%d/%d</link><guid>%d-%d</guid><pubDate>%@</pubDate><description>%@</description></item>\n", fid, a, kFixtureHost, fid, a, fid, a, FixtureDate(a, NO), text]; break;
+			case FixtureAtom: [str appendFormat:@"<entry><title>Article %d.%d</title><link href=\"https://%@/%d/%d\"/><id>%d-%d</id><updated>%@</updated><summary>%@</summary></entry>\n", fid, a, kFixtureHost, fid, a, fid, a, FixtureDate(a, YES), text]; break;
+			case FixtureHTML: [str appendFormat:@"<article><a href=\"https://%@/%d/%d\"><h2>Article %d.%d</h2></a><p>%@</p></article>\n", kFixtureHost, fid, a, fid, a, text]; break;
+		}
+	}
+	switch (kind) {
+		case FixtureRSS: [str appendString:@"</channel></rss>\n"]; break;
+		case FixtureAtom: [str appendString:@"</feed>\n"]; break;
+		case FixtureHTML: [str appendString:@"</body></html>\n"]; break;
+	}
+	return [str dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+/// @return OPML document with @c count feeds, grouped in folders of @c kFixtureGroupSize feeds.
+static NSData* FixtureOPML(int32_t count) {
+	static NSString* const kinds[] = { @"rss", @"atom", @"html" };
+	NSMutableString *str = [NSMutableString stringWithString:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<opml version=\"1.0\"><head><title>Fixture</title></head><body>\n"];
+	for (int32_t fid = 0; fid < count; fid++) {
+		if (fid % kFixtureGroupSize == 0)
+			[str appendFormat:@"<outline text=\"Group %d\">\n", fid / kFixtureGroupSize];
+		[str appendFormat:@"<outline text=\"Feed %d\" type=\"rss\" xmlUrl=\"http://%@/%@/%d\"/>\n", fid, kFixtureHost, kinds[FixtureKindForID(fid)], fid];
+		if (fid % kFixtureGroupSize == kFixtureGroupSize - 1 || fid == count - 1)
+			[str appendString:@"</outline>\n"];
+	}
+	[str appendString:@"</body></opml>\n"];
+	return [str dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+
+// ################################################################
+// #  MARK: - FixtureURLProtocol -
+// ################################################################
+
+@implementation FixtureURLProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request {
+	return [request.URL.host isEqualToString:kFixtureHost];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request {
+	return request;
+}
+
+/// Respond after configured latency. Client must be called on the same thread, thus no dispatch queue.
+- (void)startLoading {
+	NSTimeInterval delay = _fixture.latency * (0.5 + drand48());
+	[self performSelector:@selector(respond) withObject:nil afterDelay:delay inModes:@[NSRunLoopCommonModes]];
+}
+
+- (void)stopLoading {
+	[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(respond) object:nil];
+}
+
+/// Serve @c /opml?feeds=N or @c /{rss|atom|html}/{id}
+- (void)respond {
+	NSURL *url = self.request.URL;
+	NSArray<NSString*> *comp = url.pathComponents; // ["/", "rss", "12"]
+	NSInteger status = 200;
+	NSData *body = nil;
+	NSMutableDictionary *header = [NSMutableDictionary dictionary];
+	if ([comp.lastObject isEqualToString:@"opml"]) {
+		NSURLComponents *uc = [NSURLComponents componentsWithURL:url resolvingAgainstBaseURL:NO];
+		NSString *feeds = [uc.queryItems filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"name = 'feeds'"]].firstObject.value;
+		body = FixtureOPML((int32_t)feeds.intValue);
+		header[@"Content-Type"] = @"text/x-opml";
+	} else if (comp.count == 3) {
+		int32_t fid = (int32_t)comp[2].intValue;
+		int32_t round = atomic_load(&_fixture.round);
+		FixtureKind kind = FixtureKindForID(fid);
+		NSString *etag = [NSString stringWithFormat:@"\"%d-%d\"", fid, FixtureVersion(fid, round)];
+		if (FixtureHash(fid, round, 2) < _fixture.errorRate) {
+			status = 503;
+			body = [@"<html><body>Service Unavailable</body></html>" dataUsingEncoding:NSUTF8StringEncoding];
+		} else if ([[self.request valueForHTTPHeaderField:@"If-None-Match"] isEqualToString:etag]) {
+			status = 304;
+		} else {
+			body = FixtureDocument(kind, fid, FixtureVersion(fid, round));
+			header[@"Content-Type"] = (kind == FixtureHTML) ? @"text/html" : (kind == FixtureAtom) ? @"application/atom+xml" : @"application/rss+xml";
+		}
+		header[@"ETag"] = etag;
+	} else {
+		status = 404;
+	}
+	header[@"Content-Length"] = [NSString stringWithFormat:@"%lu", body.length];
+	NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:url statusCode:status HTTPVersion:@"HTTP/1.1" headerFields:header];
+	[self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+	if (body.length > 0)
+		[self.client URLProtocol:self didLoadData:body];
+	[self.client URLProtocolDidFinishLoading:self];
+}
+
+@end
+
+
+// ################################################################
+// #  MARK: - IngestBenchmark -
+// ################################################################
+
+/// @return Resident memory in MB. Either current or peak since app launch.
+static double ResidentMB(BOOL peak) {
+	struct mach_task_basic_info info;
+	mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) != KERN_SUCCESS)
+		return 0;
+	return (peak ? info.resident_size_max : info.resident_size) / 1048576.0;
+}
+
+/// @return Percentile @c p (0–1) of @c values in milliseconds. Negative values (stage skipped) are ignored.
+static double PercentileMS(NSArray<NSNumber*> *values, double p) {
+	NSArray<NSNumber*> *sorted = [[values filteredArrayUsingPredicate:[NSPredicate predicateWithFormat:@"SELF >= 0"]] sortedArrayUsingSelector:@selector(compare:)];
+	if (sorted.count == 0)
+		return 0;
+	NSUInteger idx = (NSUInteger)ceil(p * sorted.count);
+	return sorted[(idx > 0 ? idx - 1 : 0)].doubleValue * 1000;
+}
+
+
+@interface IngestBenchmark()
+@property (nonatomic, assign) int32_t feedCount;
+@property (nonatomic, assign) int32_t rounds;
+@property (nonatomic, strong) NSURL *storeURL;
+@property (nonatomic, strong) NSManagedObjectContext *moc;
+// Round state (main thread only)
+@property (nonatomic, assign) int32_t round;
+@property (nonatomic, assign) NSUInteger running;
+@property (nonatomic, assign) NSUInteger transactions;
+@property (nonatomic, assign) CFAbsoluteTime roundStart;
+@property (nonatomic, strong) NSMutableArray<FeedUpdateMetrics*> *pending; // not saved yet
+@property (nonatomic, strong) NSMutableArray<FeedUpdateMetrics*> *finished; // saved
+@end
+
+@implementation IngestBenchmark
+
+/**
+ Parameters are optional @c key=value pairs:
+ @c feeds (default 200), @c rounds (3), @c latency (ms, 30), @c errors (0.02), @c changed (0.2)
+ */
++ (void)runWithParameters:(NSArray<NSString*>*)params {
+	IngestBenchmark *this = [IngestBenchmark new];
+	this.feedCount = 200;
+	this.rounds = 3;
+	for (NSString *param in params) {
+		NSArray<NSString*> *kv = [param componentsSeparatedByString:@"="];
+		if (kv.count != 2) continue;
+		if ([kv[0] isEqualToString:@"feeds"])        this.feedCount = MAX(1, (int32_t)kv[1].intValue);
+		else if ([kv[0] isEqualToString:@"rounds"])  this.rounds = MAX(1, (int32_t)kv[1].intValue);
+		else if ([kv[0] isEqualToString:@"latency"]) _fixture.latency = kv[1].doubleValue / 1000;
+		else if ([kv[0] isEqualToString:@"errors"])  _fixture.errorRate = kv[1].doubleValue;
+		else if ([kv[0] isEqualToString:@"changed"]) _fixture.changeRate = kv[1].doubleValue;
+	}
+	atomic_store(&_fixture.round, 0);
+	srand48(42);
+	printf("--- ingest benchmark: %d feeds, %d rounds, latency %.0f ms, errors %.2f, changed %.2f ---\n",
+		   this.feedCount, this.rounds, _fixture.latency * 1000, _fixture.errorRate, _fixture.changeRate);
+	if ([this createStore])
+		[this importFixtureOPML];
+}
+
+/// Create temporary SQLite store with the same model as the app. Context is bound to main queue like in @c UpdateScheduler callbacks.
+- (BOOL)createStore {
+	NSManagedObjectModel *model = [(AppHook*)NSApp persistentContainer].managedObjectModel;
+	self.storeURL = [[NSURL fileURLWithPath:NSTemporaryDirectory()] URLByAppendingPathComponent:@"ingest-benchmark.sqlite"];
+	NSPersistentStoreCoordinator *psc = [[NSPersistentStoreCoordinator alloc] initWithManagedObjectModel:model];
+	[psc destroyPersistentStoreAtURL:self.storeURL withType:NSSQLiteStoreType options:nil error:nil];
+	NSError *err;
+	[psc addPersistentStoreWithType:NSSQLiteStoreType configuration:nil URL:self.storeURL options:nil error:&err];
+	if ([err inCaseLog:"Couldn't create benchmark store"])
+		return NO;
+	self.moc = [[NSManagedObjectContext alloc] initWithConcurrencyType:NSMainQueueConcurrencyType];
+	self.moc.persistentStoreCoordinator = psc;
+	self.moc.undoManager = nil;
+	return YES;
+}
+
+/// Download and parse fixture OPML, then insert one feed per @c xmlUrl . HTML feeds get a regex converter.
+- (void)importFixtureOPML {
+	NSString *url = [NSString stringWithFormat:@"http://%@/opml?feeds=%d", kFixtureHost, self.feedCount];
+	[[NSURLRequest withURL:url] dataTask:^(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response) {
+		if ([error inCaseLog:"Couldn't load fixture OPML"])
+			return;
+		RSXMLData *xml = [[RSXMLData alloc] initWithData:data url:response.URL];
+		[[RSOPMLParser parserWithXMLData:xml] parseAsync:^(RSOPMLItem * _Nullable doc, NSError * _Nullable err) {
+			if ([err inCaseLog:"Couldn't parse fixture OPML"])
+				return;
+			NSMutableArray<NSString*> *urls = [NSMutableArray arrayWithCapacity:(NSUInteger)self.feedCount];
+			[self collectURLs:doc into:urls];
+			dispatch_async(dispatch_get_main_queue(), ^{
+				[self insertFeeds:urls];
+				[self startRound];
+			});
+		}];
+	}];
+}
+
+/// Recursively collect @c xmlUrl attributes of all outline items.
+- (void)collectURLs:(RSOPMLItem*)item into:(NSMutableArray<NSString*>*)urls {
+	NSString *url = [item attributeForKey:OPMLXMLURLKey];
+	if (url) [urls addObject:url];
+	for (RSOPMLItem *child in item.children)
+		[self collectURLs:child into:urls];
+}
+
+/// Insert feeds into throwaway store. Not part of the measurement.
+- (void)insertFeeds:(NSArray<NSString*>*)urls {
+	int32_t idx = 0;
+	for (NSString *url in urls) {
+		FeedGroup *fg = [FeedGroup newGroup:FEED inContext:self.moc];
+		fg.sortIndex = idx++;
+		fg.feed.meta.url = url;
+		if ([url containsString:@"/html/"]) {
+			RegexConverter *rx = [RegexConverter newInContext:self.moc];
+			[rx setEntryIfChanged:@"<article>[\\s\\S]*?</article>"];
+			[rx setHrefIfChanged:@"href=\"([^\"]*)\""];
+			[rx setTitleIfChanged:@"<h2>([^<]*)</h2>"];
+			[rx setDescIfChanged:@"<p>([^<]*)</p>"];
+			fg.feed.regex = rx;
+		}
+	}
+	NSError *err;
+	[self.moc save:&err];
+	[err inCaseLog:"Couldn't save benchmark store"];
+	[self.moc reset];
+	printf("imported %lu feeds from fixture OPML\n", urls.count);
+}
+
+//  ---------------------------------------------------------------
+// |  MARK: - Rounds
+//  ---------------------------------------------------------------
+
+/// Start download of all feeds. First round is cold (empty store), later rounds use @c ETag and payload digest.
+- (void)startRound {
+	atomic_store(&_fixture.round, self.round);
+	self.pending = [NSMutableArray array];
+	self.finished = [NSMutableArray array];
+	self.transactions = 0;
+	NSArray<Feed*> *list = [[[Feed fetchRequest] prefetch:@[@"meta", @"regex"]] fetchAllRows:self.moc];
+	self.running = list.count;
+	self.roundStart = CFAbsoluteTimeGetCurrent();
+	for (Feed *feed in list) {
+		[[FeedDownload withFeed:feed forced:NO] startWithBlock:^(FeedDownload *mem) {
+			[mem copyValuesTo:feed ignoreError:NO unreadDiff:nil];
+			if (mem.metrics)
+				[self.pending addObject:mem.metrics];
+			if (self.pending.count >= kBenchmarkCommitBatch)
+				[self commit];
+			if (--self.running == 0)
+				[self finishRound];
+		}];
+	}
+}
+
+/// Save all pending changes in a single transaction, same as @c flushCommits in @c UpdateScheduler .
+- (void)commit {
+	if (self.moc.hasChanges) {
+		for (FeedUpdateMetrics *m in self.pending)
+			[m begin:UpdateStageSave];
+		NSError *err;
+		[self.moc save:&err];
+		[err inCaseLog:"Couldn't save benchmark store"];
+		for (FeedUpdateMetrics *m in self.pending)
+			[m end:UpdateStageSave];
+		self.transactions += 1;
+	}
+	[self.finished addObjectsFromArray:self.pending];
+	[self.pending removeAllObjects];
+}
+
+/// Print round statistics and continue with next round. Destroy store after last round.
+- (void)finishRound {
+	[self commit];
+	CFAbsoluteTime elapsed = CFAbsoluteTimeGetCurrent() - self.roundStart;
+	NSUInteger unchanged = 0, failed = 0;
+	for (FeedUpdateMetrics *m in self.finished) {
+		if (m.failed) failed += 1;
+		else if (m.unchanged) unchanged += 1;
+	}
+	printf("--- round %d/%d (%s) ---\n", self.round + 1, self.rounds, self.round == 0 ? "cold" : "warm");
+	printf("feeds: %lu (unchanged %lu, failed %lu) in %.2f s → %.1f feeds/s\n",
+		   self.finished.count, unchanged, failed, elapsed, self.finished.count / MAX(elapsed, 0.001));
+	printf("SQLite transactions: %lu\n", self.transactions);
+	const char *names[] = { "download", "parse", "reconcile", "save" };
+	for (UpdateStage stage = UpdateStageDownload; stage <= UpdateStageSave; stage++) {
+		NSMutableArray<NSNumber*> *values = [NSMutableArray arrayWithCapacity:self.finished.count];
+		for (FeedUpdateMetrics *m in self.finished)
+			[values addObject:@([m durationForStage:stage])];
+		printf("%-10s p50 %8.2f ms   p99 %8.2f ms\n", names[stage], PercentileMS(values, 0.5), PercentileMS(values, 0.99));
+	}
+	printf("resident memory: %.1f MB (peak %.1f MB)\n", ResidentMB(NO), ResidentMB(YES));
+
+	[self.moc reset];
+	self.round += 1;
+	if (self.round < self.rounds) {
+		[self startRound];
+	} else {
+		NSPersistentStoreCoordinator *psc = self.moc.persistentStoreCoordinator;
+		self.moc = nil;
+		[psc destroyPersistentStoreAtURL:self.storeURL withType:NSSQLiteStoreType options:nil error:nil];
+	}
+}
+
+@end
+
+#endif
@@ -4,6 +4,7 @@
 typedef NS_OPTIONS(NSUInteger, OpmlFileExportOptions) {
 	OpmlFileExportOptionFlattened = 1 << 1,
 	OpmlFileExportOptionFullBackup = 1 << 2,
+	OpmlFileExportOptionHeadless = 1 << 3, // log errors instead of showing an alert
 };
 
 NS_ASSUME_NONNULL_BEGIN
@@ -15,6 +16,8 @@ NS_ASSUME_NONNULL_BEGIN
 - (NSManagedObjectContext*)opmlFileImportContext; // currently called only once
 @optional
 - (void)opmlFileImportWillBegin:(NSManagedObjectContext*)moc;
+/// Called on main thread after each insert batch. @c done @c == @c total for the last batch.
+- (void)opmlFileImport:(NSManagedObjectContext*)moc progress:(NSUInteger)done total:(NSUInteger)total duplicates:(NSUInteger)skipped;
 - (void)opmlFileImportDidEnd:(NSManagedObjectContext*)moc;
 @end
 
@@ -40,6 +43,7 @@ NS_ASSUME_NONNULL_BEGIN
 + (instancetype)withDelegate:(nullable id<OpmlFileExportDelegate>)delegate;
 - (void)showExportDialog:(NSWindow*)window;
 - (nullable NSError*)writeOPMLFile:(NSURL*)url withOptions:(OpmlFileExportOptions)opt;
+- (nullable NSError*)writeOPMLFile:(NSURL*)url withOptions:(OpmlFileExportOptions)opt inContext:(nullable NSManagedObjectContext*)moc;
 @end
 
 NS_ASSUME_NONNULL_END
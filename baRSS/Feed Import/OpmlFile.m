@@ -8,6 +8,7 @@
 #import "NSDate+Ext.h"
 #import "NSView+Ext.h"
 #import "NSError+Ext.h"
+#import "NSFetchRequest+Ext.h"
 
 #pragma mark - Helper
 
@@ -21,6 +22,22 @@ static NSInteger RadioGroupSelection(NSView *view) {
 	return -1;
 }
 
+/// @return Normalized feed URL for duplicate detection. Ignores scheme, host case, trailing slash, and fragment.
+static NSString* FeedURLKey(NSString *url) {
+	NSString *str = [url stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceAndNewlineCharacterSet]];
+	NSURLComponents *comp = [NSURLComponents componentsWithString:str];
+	if (!comp.host)
+		return str.lowercaseString;
+	NSMutableString *key = [NSMutableString stringWithString:comp.host.lowercaseString];
+	if (comp.port)
+		[key appendFormat:@":%@", comp.port];
+	NSString *path = comp.percentEncodedPath;
+	[key appendString:([path hasSuffix:@"/"] ? [path substringToIndex:path.length - 1] : path)];
+	if (comp.percentEncodedQuery)
+		[key appendFormat:@"?%@", comp.percentEncodedQuery];
+	return key;
+}
+
 
 // ################################################################
 // #
@@ -29,6 +46,27 @@ static NSInteger RadioGroupSelection(NSView *view) {
 // ################################################################
 #pragma mark - Import
 
+/// Number of items inserted per run loop cycle.
+static NSUInteger const kImportBatchSize = 250;
+
+/// Single outline item that passed duplicate detection and is waiting to be inserted.
+@interface OpmlImportEntry : NSObject
+@property (nonatomic, strong) RSOPMLItem *item;
+@property (nonatomic, strong, nullable) OpmlImportEntry *parent;
+@property (nonatomic, assign) int32_t index; // final sortIndex within parent
+@property (nonatomic, assign) int32_t childCount; // final number of children (GROUP only)
+@property (nonatomic, strong, nullable) FeedGroup *group; // set after insert
+@end
+
+@implementation OpmlImportEntry
+@end
+
+
+@interface OpmlFileImport()
+@property (assign) NSUInteger duplicates; // number of skipped feeds with known xmlUrl
+@property (assign) int32_t rootCount; // final number of root items
+@end
+
 @implementation OpmlFileImport
 
 + (instancetype)withDelegate:(id<OpmlFileImportDelegate>)delegate {
@@ -49,24 +87,37 @@ static NSInteger RadioGroupSelection(NSView *view) {
 	}];
 }
 
-/// Perform core data import on all items of all @c files
+/**
+ Perform core data import on all items of all @c files .
+ Feeds with an already known @c xmlUrl (existing subscription or earlier in the same import) are skipped.
+ Items are inserted in batches of @c kImportBatchSize to keep the UI responsive on large files.
+ */
 - (void)importFiles:(NSArray<NSURL*>*)files {
 	id<OpmlFileImportDelegate> controller = self.delegate;
-	BOOL respondBegin = [controller respondsToSelector:@selector(opmlFileImportWillBegin:)];
-	BOOL respondEnd = [controller respondsToSelector:@selector(opmlFileImportDidEnd:)];
-	
 	NSManagedObjectContext *moc = [controller opmlFileImportContext];
-	if (respondBegin)
+	if ([controller respondsToSelector:@selector(opmlFileImportWillBegin:)])
 		[controller opmlFileImportWillBegin:moc];
 	
-	NSUInteger lastIndex = [StoreCoordinator countRootItemsInContext:moc];
-	__block NSUInteger current = lastIndex;
+	NSMutableArray<RSOPMLItem*> *roots = [NSMutableArray array];
 	[self enumerateFiles:files withBlock:^(RSOPMLItem *item) {
-		[self importFeed:item parent:nil index:(int32_t)current inContext:moc];
-		current += 1;
-	} finally:(!respondEnd ? nil : ^{ // ignore block if delegate doesn't respond
-		[controller opmlFileImportDidEnd:moc];
-	})];
+		[roots addObject:item];
+	} finally:^{
+		NSMutableSet<NSString*> *known = [self existingFeedURLsInContext:moc];
+		NSMutableArray<OpmlImportEntry*> *list = [NSMutableArray array];
+		NSArray<FeedGroup*> *existing = [StoreCoordinator sortedFeedGroupsWithParent:nil inContext:moc];
+		int32_t current = (int32_t)existing.count;
+		for (RSOPMLItem *item in roots) {
+			if ([self collect:item parent:nil index:current into:list known:known])
+				current += 1;
+		}
+		self.rootCount = current;
+		// nested interval of existing root items depends on the final number of root items
+		if ((NSUInteger)current > existing.count) {
+			for (FeedGroup *fg in existing)
+				[fg updateTreeInterval:NO siblings:(NSUInteger)current];
+		}
+		[self importEntries:list from:0 inContext:moc];
+	}];
 }
 
 /// Loop over all files and parse XML data. Calls @c block() for each root @c RSOPMLItem.
@@ -89,15 +140,83 @@ static NSInteger RadioGroupSelection(NSView *view) {
 	if (finally) dispatch_group_notify(group, dispatch_get_main_queue(), finally);
 }
 
+/// @return Set of normalized @c url of all existing feeds (see @c FeedURLKey() ).
+- (NSMutableSet<NSString*>*)existingFeedURLsInContext:(NSManagedObjectContext*)moc {
+	NSArray<NSDictionary*> *rows = [[[FeedMeta fetchRequest] select:@[@"url"]] fetchAllRows:moc];
+	NSMutableSet<NSString*> *set = [NSMutableSet setWithCapacity:rows.count];
+	for (NSDictionary *d in rows) {
+		NSString *url = d[@"url"];
+		if (url) [set addObject:FeedURLKey(url)];
+	}
+	return set;
+}
+
 /**
- Import single item and recursively repeat import for each child.
+ Flatten outline tree into insert order (depth-first, parents before children). Assigns the final @c sortIndex.
+ Feeds with a known @c xmlUrl are dropped. So are groups that contained only duplicates (empty groups are kept).
+
+ @param known Normalized feed URLs. New URLs are added, so that duplicates within the file are skipped too.
+ @return @c YES if @c item will be inserted.
+ */
+- (BOOL)collect:(RSOPMLItem*)item parent:(nullable OpmlImportEntry*)parent index:(int32_t)idx into:(NSMutableArray<OpmlImportEntry*>*)list known:(NSMutableSet<NSString*>*)known {
+	NSString *url = [item attributeForKey:OPMLXMLURLKey];
+	if (url) {
+		NSString *key = FeedURLKey(url);
+		if ([known containsObject:key]) {
+			self.duplicates += 1;
+			return NO;
+		}
+		[known addObject:key];
+	}
+	OpmlImportEntry *entry = [OpmlImportEntry new];
+	entry.item = item;
+	entry.parent = parent;
+	entry.index = idx;
+	[list addObject:entry];
+	if (!url && item.children.count > 0) { // GROUP
+		int32_t i = 0;
+		for (RSOPMLItem *child in item.children) {
+			if ([self collect:child parent:entry index:i into:list known:known])
+				i += 1;
+		}
+		if (i == 0) { // all children were duplicates, entry is still the last item
+			[list removeLastObject];
+			return NO;
+		}
+		entry.childCount = i;
+	}
+	return YES;
+}
+
+/// Insert up to @c kImportBatchSize entries, report progress, and continue with the next batch on the next run loop cycle.
+- (void)importEntries:(NSArray<OpmlImportEntry*>*)list from:(NSUInteger)start inContext:(NSManagedObjectContext*)moc {
+	NSUInteger end = MIN(start + kImportBatchSize, list.count);
+	for (NSUInteger i = start; i < end; i++) {
+		[self importEntry:list[i] inContext:moc];
+	}
+	[moc processPendingChanges];
+	
+	id<OpmlFileImportDelegate> controller = self.delegate;
+	if ([controller respondsToSelector:@selector(opmlFileImport:progress:total:duplicates:)])
+		[controller opmlFileImport:moc progress:end total:list.count duplicates:self.duplicates];
+	
+	if (end < list.count) {
+		dispatch_async(dispatch_get_main_queue(), ^{
+			[self importEntries:list from:end inContext:moc];
+		});
+	} else if ([controller respondsToSelector:@selector(opmlFileImportDidEnd:)]) {
+		[controller opmlFileImportDidEnd:moc];
+	}
+}
+
+/**
+ Import single item. Parent item must be inserted already (see @c collect:parent:index:into:known: ).
  
- @param item The item to be imported.
- @param parent The already processed parent item.
- @param idx @c sortIndex within the @c parent item.
+ @param entry The item to be imported. Inserted @c FeedGroup is stored in @c entry.group
  @param moc Managed object context.
  */
-- (void)importFeed:(RSOPMLItem*)item parent:(FeedGroup*)parent index:(int32_t)idx inContext:(NSManagedObjectContext*)moc {
+- (void)importEntry:(OpmlImportEntry*)entry inContext:(NSManagedObjectContext*)moc {
+	RSOPMLItem *item = entry.item;
 	FeedGroupType type = GROUP;
 	if ([item attributeForKey:OPMLXMLURLKey]) {
 		type = FEED;
@@ -106,7 +225,9 @@ static NSInteger RadioGroupSelection(NSView *view) {
 	}
 	
 	FeedGroup *newFeed = [FeedGroup newGroup:type inContext:moc];
-	[newFeed setParent:parent andSortIndex:idx];
+	int32_t siblings = entry.parent ? entry.parent.childCount : self.rootCount;
+	[newFeed setParent:entry.parent.group andSortIndex:entry.index siblings:(NSUInteger)siblings];
+	entry.group = newFeed;
 	
 	if (type == SEPARATOR)
 		return;
@@ -115,7 +236,7 @@ static NSInteger RadioGroupSelection(NSView *view) {
 	
 	if (type == FEED) {
 		id refresh = [item attributeForKey:@"refreshInterval"]; // baRSS specific
-		int32_t interval = kDefaultFeedRefreshInterval; // TODO: set -1, then auto
+		int32_t interval = kFeedRefreshAuto;
 		if (refresh)
 			interval = (int32_t)[refresh integerValue];
 		
@@ -139,10 +260,6 @@ static NSInteger RadioGroupSelection(NSView *view) {
 			rx.dateFormat = rxDateFormat;
 			newFeed.feed.regex = rx;
 		}
-	} else { // GROUP
-		for (NSUInteger i = 0; i < item.children.count; i++) {
-			[self importFeed:item.children[i] parent:newFeed index:(int32_t)i inContext:moc];
-		}
 	}
 }
 
@@ -192,6 +309,92 @@ static NSInteger RadioGroupSelection(NSView *view) {
 // ################################################################
 #pragma mark - Export
 
+/// Max. number of bytes buffered before writing to file.
+static NSUInteger const kExportBufferSize = 64 * 1024;
+
+/// Append @c key="value" to @c str . XML special characters are replaced by entities. Does nothing if @c value @c == @c nil .
+static void AppendAttribute(NSMutableString *str, NSString *key, NSString *value) {
+	static NSCharacterSet *special;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		NSMutableCharacterSet *set = [NSMutableCharacterSet controlCharacterSet];
+		[set addCharactersInString:@"&<>\""];
+		special = set;
+	});
+	if (!value)
+		return;
+	[str appendFormat:@" %@=\"", key];
+	if ([value rangeOfCharacterFromSet:special].location == NSNotFound) {
+		[str appendString:value]; // fast path, nothing to escape
+	} else {
+		for (NSUInteger i = 0; i < value.length; i++) {
+			unichar c = [value characterAtIndex:i];
+			switch (c) {
+				case '&':  [str appendString:@"&amp;"]; break;
+				case '<':  [str appendString:@"&lt;"]; break;
+				case '>':  [str appendString:@"&gt;"]; break;
+				case '"':  [str appendString:@"&quot;"]; break;
+				case '\t': [str appendString:@"&#9;"]; break;
+				case '\n': [str appendString:@"&#10;"]; break;
+				case '\r': [str appendString:@"&#13;"]; break;
+				default:
+					if (c >= 0x20) // other control characters are not allowed in XML 1.0
+						[str appendFormat:@"%C", c];
+			}
+		}
+	}
+	[str appendString:@"\""];
+}
+
+/// Buffered UTF-8 file writer. Data is flushed to disk every @c kExportBufferSize bytes.
+@interface OpmlStreamWriter : NSObject
+@property (strong) NSOutputStream *stream;
+@property (strong) NSMutableData *buffer;
+@property (strong, nullable) NSError *error; // first write error, subsequent writes are ignored
+@end
+
+@implementation OpmlStreamWriter
+
++ (instancetype)writerWithURL:(NSURL*)url {
+	OpmlStreamWriter *w = [[super alloc] init];
+	w.stream = [NSOutputStream outputStreamWithURL:url append:NO];
+	w.buffer = [NSMutableData dataWithCapacity:kExportBufferSize];
+	[w.stream open];
+	return w;
+}
+
+/// Append UTF-8 representation of @c str to buffer. Flush if buffer is full.
+- (void)write:(NSString*)str {
+	// lossy conversion, UTF8String would return NULL for strings with unpaired surrogates
+	[_buffer appendData:[str dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:YES]];
+	if (_buffer.length >= kExportBufferSize)
+		[self flush];
+}
+
+/// Write buffer to output stream and clear buffer.
+- (void)flush {
+	const uint8_t *bytes = _buffer.bytes;
+	NSUInteger total = _buffer.length, done = 0;
+	while (!_error && done < total) {
+		NSInteger n = [_stream write:bytes + done maxLength:total - done];
+		if (n > 0)
+			done += (NSUInteger)n;
+		else
+			_error = _stream.streamError ?: [NSError errorWithDomain:NSCocoaErrorDomain code:NSFileWriteUnknownError userInfo:nil];
+	}
+	_buffer.length = 0;
+}
+
+/// Flush remaining data and close stream. @return First error that occurred during write (if any).
+- (nullable NSError*)close {
+	[self flush];
+	[_stream close];
+	return _error;
+}
+
+@end
+
+
 @implementation OpmlFileExport
 
 + (instancetype)withDelegate:(nullable id<OpmlFileExportDelegate>)delegate {
@@ -230,95 +433,141 @@ static NSInteger RadioGroupSelection(NSView *view) {
 	}];
 }
 
+- (nullable NSError*)writeOPMLFile:(NSURL*)url withOptions:(OpmlFileExportOptions)opt {
+	return [self writeOPMLFile:url withOptions:opt inContext:nil];
+}
+
 /**
- Convert list of @c FeedGroup to @c NSXMLDocument and write to local file @c url.
- On error: show application alert (which is also returned).
+ Stream list of @c FeedGroup as OPML to local file @c url. Data is written to a temporary file, then moved to @c url.
+ On error: show application alert (unless @c OpmlFileExportOptionHeadless is set). Error is also returned.
  
  @note Calls @c opmlExportListOfFeedGroups: on @c delegate to obtain export list.
+ @param moc Used to fetch all root items if @c delegate @c == @c nil . If @c nil use main context.
  */
-- (nullable NSError*)writeOPMLFile:(NSURL*)url withOptions:(OpmlFileExportOptions)opt {
+- (nullable NSError*)writeOPMLFile:(NSURL*)url withOptions:(OpmlFileExportOptions)opt inContext:(nullable NSManagedObjectContext*)moc {
 	NSArray<FeedGroup*> *list = [self.delegate opmlFileExportListOfFeedGroups:opt];
-	if (!list) list = [StoreCoordinator sortedFeedGroupsWithParent:nil inContext:nil]; // fetch all if delegate == nil
+	if (!list) list = [StoreCoordinator sortedFeedGroupsWithParent:nil inContext:moc]; // fetch all if delegate == nil
 	NSError *error;
 	// TODO: set error if nil or empty
 	if (list.count > 0) {
-		BOOL keepTree = !(opt & OpmlFileExportOptionFlattened);
-		NSXMLDocument *doc = [self xmlDocumentForFeeds:list hierarchical:keepTree];
-		NSData *xml = [doc XMLDataWithOptions:NSXMLNodePreserveAttributeOrder | NSXMLNodePrettyPrint];
-		[xml writeToURL:url options:NSDataWritingAtomic error:&error];
+		NSFileManager *fm = [NSFileManager defaultManager];
+		NSURL *tmpDir = [fm URLForDirectory:NSItemReplacementDirectory inDomain:NSUserDomainMask appropriateForURL:url create:YES error:&error];
+		if (tmpDir) {
+			NSURL *tmp = [tmpDir URLByAppendingPathComponent:url.lastPathComponent];
+			OpmlStreamWriter *writer = [OpmlStreamWriter writerWithURL:tmp];
+			BOOL keepTree = !(opt & OpmlFileExportOptionFlattened);
+			[self writeFeeds:list hierarchical:keepTree to:writer];
+			error = [writer close];
+			if (!error) {
+				if ([fm fileExistsAtPath:url.path])
+					[fm replaceItemAtURL:url withItemAtURL:tmp backupItemName:nil options:0 resultingItemURL:nil error:&error];
+				else
+					[fm moveItemAtURL:tmp toURL:url error:&error];
+			}
+			[fm removeItemAtURL:tmpDir error:nil];
+		}
 	}
-	[error inCasePresent:NSApp];
+	if (opt & OpmlFileExportOptionHeadless)
+		[error inCaseLog:"OPML export"];
+	else
+		[error inCasePresent:NSApp];
 	return error;
 }
 
+/// @return New request for @c FeedGroup items sorted by @c sortIndex . Related @c feed , @c feed.meta , and @c feed.regex are prefetched.
+static NSFetchRequest<FeedGroup*> *PrefetchingFeedGroupRequest(void) {
+	NSFetchRequest<FeedGroup*> *fr = [[[FeedGroup fetchRequest] sortASC:@"sortIndex"] prefetch:@[@"feed", @"feed.meta", @"feed.regex"]];
+	fr.returnsObjectsAsFaults = NO;
+	return fr;
+}
+
+/**
+ Fetch all descendants of @c list with one request per tree level. Items outside of the selected subtrees are not loaded.
+ Items of @c list are fetched again to prefetch their related objects.
+ @return Children of each group (sorted by @c sortIndex ), keyed by object ID of parent.
+ */
+- (NSDictionary<NSManagedObjectID*, NSArray<FeedGroup*>*>*)prefetchedChildrenOf:(NSArray<FeedGroup*>*)list {
+	NSManagedObjectContext *moc = list.firstObject.managedObjectContext;
+	NSMutableDictionary<NSManagedObjectID*, NSMutableArray<FeedGroup*>*> *map = [NSMutableDictionary dictionary];
+	NSArray<FeedGroup*> *level = [[PrefetchingFeedGroupRequest() where:@"self IN %@", list] fetchAllRows:moc];
+	while (level.count > 0) {
+		NSMutableArray<FeedGroup*> *groups = [NSMutableArray array];
+		for (FeedGroup *fg in level) {
+			if (fg.type == GROUP)
+				[groups addObject:fg];
+		}
+		if (groups.count == 0)
+			break;
+		level = [[PrefetchingFeedGroupRequest() where:@"parent IN %@", groups] fetchAllRows:moc];
+		for (FeedGroup *fg in level) {
+			NSManagedObjectID *parent = [fg objectIDsForRelationshipNamed:@"parent"].firstObject; // without firing fault
+			NSMutableArray<FeedGroup*> *children = map[parent];
+			if (!children)
+				map[parent] = children = [NSMutableArray array];
+			[children addObject:fg];
+		}
+	}
+	return map;
+}
+
 /**
- Create NSXMLNode structure with application header nodes and body node containing feed items.
+ Write application header, body with feed items, and footer.
  
  @param flag If @c YES keep parent-child structure intact. If @c NO ignore all parents and add @c Feed items only.
  */
-- (NSXMLDocument*)xmlDocumentForFeeds:(NSArray<FeedGroup*>*)list hierarchical:(BOOL)flag {
-	NSXMLElement *head = [NSXMLElement elementWithName:@"head"];
-	head.children = @[[NSXMLElement elementWithName:@"title" stringValue:@"baRSS feeds"],
-					  [NSXMLElement elementWithName:@"ownerName" stringValue:@"baRSS"],
-					  [NSXMLElement elementWithName:@"dateCreated" stringValue:[NSDate timeStringISO8601]] ];
-	
-	NSXMLElement *body = [NSXMLElement elementWithName:@"body"];
+- (void)writeFeeds:(NSArray<FeedGroup*>*)list hierarchical:(BOOL)flag to:(OpmlStreamWriter*)w {
+	NSDictionary<NSManagedObjectID*, NSArray<FeedGroup*>*> *tree = [self prefetchedChildrenOf:list];
+	[w write:@"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<opml version=\"1.0\">\n\t<head>\n"];
+	[w write:@"\t\t<title>baRSS feeds</title>\n\t\t<ownerName>baRSS</ownerName>\n"];
+	[w write:[NSString stringWithFormat:@"\t\t<dateCreated>%@</dateCreated>\n\t</head>\n\t<body>\n", [NSDate timeStringISO8601]]];
 	for (FeedGroup *item in list) {
-		[self appendChild:item toNode:body hierarchical:flag];
+		[self writeItem:item tree:tree depth:2 hierarchical:flag to:w];
 	}
-	
-	NSXMLElement *opml = [NSXMLElement elementWithName:@"opml"];
-	opml.attributes = @[[NSXMLNode attributeWithName:@"version" stringValue:@"1.0"]];
-	opml.children = @[head, body];
-	
-	NSXMLDocument *xml = [NSXMLDocument documentWithRootElement:opml];
-	xml.version = @"1.0";
-	xml.characterEncoding = @"UTF-8";
-	return xml;
+	[w write:@"\t</body>\n</opml>\n"];
 }
 
 /**
- Build up @c NSXMLNode structure recursively. Essentially, re-create same structure as in core data storage.
+ Write @c outline element and continue recursively. Essentially, re-create same structure as in core data storage.
  
  @param flag If @c NO don't add groups to export file but continue evaluation of child items.
  */
-- (void)appendChild:(FeedGroup*)item toNode:(NSXMLElement *)parent hierarchical:(BOOL)flag {
-	if (flag || item.type != GROUP) {
-		// dont add group node if hierarchical == NO
-		NSXMLElement *outline = [NSXMLElement elementWithName:@"outline"];
-		[parent addChild:outline];
-		[outline addAttribute:[NSXMLNode attributeWithName:OPMLTitleKey stringValue:item.anyName]];
-		[outline addAttribute:[NSXMLNode attributeWithName:OPMLTextKey stringValue:item.anyName]];
+- (void)writeItem:(FeedGroup*)item tree:(NSDictionary<NSManagedObjectID*, NSArray<FeedGroup*>*>*)tree depth:(NSUInteger)depth hierarchical:(BOOL)flag to:(OpmlStreamWriter*)w {
+	NSArray<FeedGroup*> *children = tree[item.objectID];
+	BOOL addNode = (flag || item.type != GROUP); // dont add group node if hierarchical == NO
+	if (addNode) {
+		NSMutableString *str = [NSMutableString stringWithString:[@"" stringByPaddingToLength:depth withString:@"\t" startingAtIndex:0]];
+		[str appendString:@"<outline"];
+		NSString *name = item.anyName;
+		AppendAttribute(str, OPMLTitleKey, name);
+		AppendAttribute(str, OPMLTextKey, name);
 		
 		if (item.type == SEPARATOR) {
-			[outline addAttribute:[NSXMLNode attributeWithName:@"separator" stringValue:@"true"]]; // baRSS specific
+			AppendAttribute(str, @"separator", @"true"); // baRSS specific
 		} else if (item.feed) {
-			[outline addAttribute:[NSXMLNode attributeWithName:OPMLHMTLURLKey stringValue:item.feed.link]];
-			[outline addAttribute:[NSXMLNode attributeWithName:OPMLXMLURLKey stringValue:item.feed.meta.url]];
-			[outline addAttribute:[NSXMLNode attributeWithName:OPMLTypeKey stringValue:@"rss"]];
-			NSString *intervalStr = [NSString stringWithFormat:@"%d", item.feed.meta.refresh];
-			[outline addAttribute:[NSXMLNode attributeWithName:@"refreshInterval" stringValue:intervalStr]]; // baRSS specific
+			AppendAttribute(str, OPMLHMTLURLKey, item.feed.link ?: @"");
+			AppendAttribute(str, OPMLXMLURLKey, item.feed.meta.url ?: @"");
+			AppendAttribute(str, OPMLTypeKey, @"rss");
+			AppendAttribute(str, @"refreshInterval", [NSString stringWithFormat:@"%d", item.feed.meta.refresh]); // baRSS specific
 			RegexConverter *rx = item.feed.regex;
 			if (rx) { // baRSS specific
-				if (rx.entry)
-					[outline addAttribute:[NSXMLNode attributeWithName:@"rxEntry" stringValue:rx.entry]];
-				if (rx.href)
-					[outline addAttribute:[NSXMLNode attributeWithName:@"rxHref" stringValue:rx.href]];
-				if (rx.title)
-					[outline addAttribute:[NSXMLNode attributeWithName:@"rxTitle" stringValue:rx.title]];
-				if (rx.desc)
-					[outline addAttribute:[NSXMLNode attributeWithName:@"rxDesc" stringValue:rx.desc]];
-				if (rx.date)
-					[outline addAttribute:[NSXMLNode attributeWithName:@"rxDate" stringValue:rx.date]];
-				if (rx.dateFormat)
-					[outline addAttribute:[NSXMLNode attributeWithName:@"rxDateFormat" stringValue:rx.dateFormat]];
+				AppendAttribute(str, @"rxEntry", rx.entry);
+				AppendAttribute(str, @"rxHref", rx.href);
+				AppendAttribute(str, @"rxTitle", rx.title);
+				AppendAttribute(str, @"rxDesc", rx.desc);
+				AppendAttribute(str, @"rxDate", rx.date);
+				AppendAttribute(str, @"rxDateFormat", rx.dateFormat);
 			}
 			// TODO: option to export unread state?
 		}
-		parent = outline;
+		[str appendString:(children.count > 0 ? @">\n" : @"/>\n")];
+		[w write:str];
+		depth += 1;
+	}
+	for (FeedGroup *subItem in children) {
+		[self writeItem:subItem tree:tree depth:depth hierarchical:flag to:w];
 	}
-	for (FeedGroup *subItem in [item sortedChildren]) {
-		[self appendChild:subItem toNode:parent hierarchical:flag];
+	if (addNode && children.count > 0) {
+		[w write:[[@"" stringByPaddingToLength:depth - 1 withString:@"\t" startingAtIndex:0] stringByAppendingString:@"</outline>\n"]];
 	}
 }
 
@@ -0,0 +1,44 @@
+@import Cocoa;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Timed stages of a single feed update. Each stage is also logged as @c os_signpost interval.
+typedef NS_ENUM(NSUInteger, UpdateStage) {
+	UpdateStageDownload = 0,
+	UpdateStageParse = 1,
+	UpdateStageReconcile = 2,
+	UpdateStageSave = 3,
+};
+
+/// Timeline of a single feed download. Durations are in seconds, @c -1 if stage did not happen.
+@interface FeedUpdateMetrics : NSObject
+@property (readonly, copy) NSString *url;
+@property (readonly, strong) NSDate *date;
+@property (assign) NSInteger statusCode;
+@property (assign) int64_t bytes; // response body (compressed, as transferred)
+@property (assign) BOOL unchanged; // 304 or identical payload
+@property (assign) BOOL failed;
+// Network timeline (from NSURLSessionTaskMetrics, last transaction)
+@property (readonly) NSTimeInterval dns, connect, tls, ttfb, transfer;
+
++ (instancetype)withURL:(NSString*)url;
+- (void)setTaskMetrics:(NSURLSessionTaskMetrics*)metrics;
+- (void)begin:(UpdateStage)stage;
+- (void)end:(UpdateStage)stage;
+- (NSTimeInterval)durationForStage:(UpdateStage)stage;
+- (NSTimeInterval)total;
+@end
+
+
+/// In-memory collection of update metrics since app launch. Thread safe.
+@interface UpdateMetrics : NSObject
++ (void)record:(FeedUpdateMetrics*)metrics;
++ (id)beginCycle;
++ (void)endCycle:(id)cycle;
+// Reports
++ (nullable NSDictionary*)summaryForFeed:(NSString*)url;
++ (NSDictionary*)report;
++ (nullable NSError*)writeReportToURL:(NSURL*)url;
+@end
+
+NS_ASSUME_NONNULL_END
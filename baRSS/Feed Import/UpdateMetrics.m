@@ -0,0 +1,300 @@
+#import "UpdateMetrics.h"
+#import "FeedArticle+Ext.h"
+#import "FaviconDownload.h"
+
+#include <os/log.h>
+#include <os/signpost.h>
+
+/// Max. number of updates kept per feed.
+static NSUInteger const kMetricsHistoryPerFeed = 20;
+/// Max. number of update cycles kept.
+static NSUInteger const kMetricsHistoryCycles = 20;
+/// Number of slowest feeds listed per update cycle.
+static NSUInteger const kMetricsSlowestFeeds = 5;
+
+/// Log handle for signposts. Shown in Instruments (os_signpost, subsystem @c de.relikd.baRSS ).
+static os_log_t MetricsLog(void) {
+	static os_log_t log;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		log = os_log_create("de.relikd.baRSS", "FeedUpdate");
+	});
+	return log;
+}
+
+/// Signpost names must be string literals, hence the switch.
+#define SIGNPOST_STAGE(fn, log, spid, stage) \
+	switch (stage) { \
+		case UpdateStageDownload:  fn(log, spid, "Download"); break; \
+		case UpdateStageParse:     fn(log, spid, "Parse"); break; \
+		case UpdateStageReconcile: fn(log, spid, "Reconcile"); break; \
+		case UpdateStageSave:      fn(log, spid, "Save"); break; \
+	}
+
+/// @return Seconds between @c from and @c to . @c -1 if either is missing (e.g., reused connection has no DNS lookup).
+static inline NSTimeInterval Interval(NSDate *from, NSDate *to) {
+	return (from && to) ? [to timeIntervalSinceDate:from] : -1;
+}
+
+/// @return ISO 8601 date string. Formatter is reused (thread safe).
+static NSString* ISODate(NSDate *date) {
+	static NSISO8601DateFormatter *formatter;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		formatter = [[NSISO8601DateFormatter alloc] init];
+	});
+	return [formatter stringFromDate:date];
+}
+
+/// @return Rounded milliseconds or @c nil if @c seconds is negative (stage did not happen).
+static inline NSNumber* Millis(NSTimeInterval seconds) {
+	return (seconds < 0) ? nil : @(llround(seconds * 1000));
+}
+
+
+// ################################################################
+// #  MARK: - FeedUpdateMetrics -
+// ################################################################
+
+@interface FeedUpdateMetrics() {
+	CFAbsoluteTime _start[4];
+	NSTimeInterval _duration[4];
+}
+@property (copy) NSString *url;
+@property (strong) NSDate *date;
+@property (assign) NSTimeInterval dns, connect, tls, ttfb, transfer;
+- (NSDictionary*)jsonObject;
+@end
+
+@implementation FeedUpdateMetrics
+
++ (instancetype)withURL:(NSString*)url {
+	FeedUpdateMetrics *this = [[super alloc] init];
+	this.url = url;
+	this.date = [NSDate date];
+	this.dns = this.connect = this.tls = this.ttfb = this.transfer = -1;
+	for (int i = 0; i < 4; i++) {
+		this->_start[i] = 0;
+		this->_duration[i] = -1;
+	}
+	return this;
+}
+
+/// Copy network timeline of last transaction (after redirects).
+- (void)setTaskMetrics:(NSURLSessionTaskMetrics*)metrics {
+	NSURLSessionTaskTransactionMetrics *t = metrics.transactionMetrics.lastObject;
+	if (!t) return;
+	self.dns = Interval(t.domainLookupStartDate, t.domainLookupEndDate);
+	self.connect = Interval(t.connectStartDate, t.connectEndDate);
+	self.tls = Interval(t.secureConnectionStartDate, t.secureConnectionEndDate);
+	self.ttfb = Interval(t.requestStartDate, t.responseStartDate);
+	self.transfer = Interval(t.responseStartDate, t.responseEndDate);
+	if (@available(macOS 10.15, *))
+		self.bytes = t.countOfResponseBodyBytesReceived;
+}
+
+/// Start timer for @c stage and begin signpost interval.
+- (void)begin:(UpdateStage)stage {
+	_start[stage] = CFAbsoluteTimeGetCurrent();
+	if (@available(macOS 10.14, *)) {
+		os_signpost_id_t spid = os_signpost_id_make_with_pointer(MetricsLog(), (__bridge void*)self);
+		SIGNPOST_STAGE(os_signpost_interval_begin, MetricsLog(), spid, stage);
+	}
+}
+
+/// Stop timer for @c stage and end signpost interval. Repeated stages (e.g., HTML page, then feed) are summed up.
+- (void)end:(UpdateStage)stage {
+	if (_start[stage] <= 0)
+		return;
+	_duration[stage] = MAX(0, _duration[stage]) + (CFAbsoluteTimeGetCurrent() - _start[stage]);
+	_start[stage] = 0;
+	if (@available(macOS 10.14, *)) {
+		os_signpost_id_t spid = os_signpost_id_make_with_pointer(MetricsLog(), (__bridge void*)self);
+		SIGNPOST_STAGE(os_signpost_interval_end, MetricsLog(), spid, stage);
+	}
+}
+
+/// @return Duration of @c stage in seconds or @c -1 if stage did not happen.
+- (NSTimeInterval)durationForStage:(UpdateStage)stage {
+	return _duration[stage];
+}
+
+/// @return Sum of all stages in seconds.
+- (NSTimeInterval)total {
+	NSTimeInterval sum = 0;
+	for (int i = 0; i < 4; i++)
+		if (_duration[i] > 0) sum += _duration[i];
+	return sum;
+}
+
+/// @return Dictionary for JSON export. All durations in milliseconds, missing stages are omitted.
+- (NSDictionary*)jsonObject {
+	NSMutableDictionary *d = [NSMutableDictionary dictionaryWithCapacity:16];
+	d[@"url"] = self.url;
+	d[@"date"] = ISODate(self.date);
+	d[@"status"] = @(self.statusCode);
+	d[@"bytes"] = @(self.bytes);
+	if (self.unchanged) d[@"unchanged"] = @YES;
+	if (self.failed) d[@"failed"] = @YES;
+	d[@"dns"] = Millis(self.dns);
+	d[@"connect"] = Millis(self.connect);
+	d[@"tls"] = Millis(self.tls);
+	d[@"ttfb"] = Millis(self.ttfb);
+	d[@"transfer"] = Millis(self.transfer);
+	d[@"download"] = Millis(_duration[UpdateStageDownload]);
+	d[@"parse"] = Millis(_duration[UpdateStageParse]);
+	d[@"reconcile"] = Millis(_duration[UpdateStageReconcile]);
+	d[@"save"] = Millis(_duration[UpdateStageSave]);
+	d[@"total"] = Millis(self.total);
+	return d;
+}
+
+@end
+
+
+// ################################################################
+// #  MARK: - UpdateMetrics -
+// ################################################################
+
+/// Update cycle that is still running. Collects all feeds recorded in the meantime.
+@interface UpdateCycle : NSObject
+@property (strong) NSDate *start;
+@property (strong) NSMutableArray<FeedUpdateMetrics*> *feeds;
+@property (assign) NSUInteger skippedConversions; // value of global counter at start
+@property (assign) int64_t faviconBytesSaved; // value of global counter at start
+@end
+
+@implementation UpdateCycle
+@end
+
+
+// Accessed within @synchronized([UpdateMetrics class]) only
+static NSMutableDictionary<NSString*, NSMutableArray<FeedUpdateMetrics*>*> *_feedHistory;
+static NSMutableArray<NSDictionary*> *_cycleHistory; // finished cycles, oldest first
+static NSMutableArray<UpdateCycle*> *_openCycles;
+
+@implementation UpdateMetrics
+
+/// Append @c metrics to history of feed and to all running update cycles.
++ (void)record:(FeedUpdateMetrics*)metrics {
+	@synchronized (self) {
+		if (!_feedHistory)
+			_feedHistory = [NSMutableDictionary dictionary];
+		NSMutableArray<FeedUpdateMetrics*> *list = _feedHistory[metrics.url];
+		if (!list)
+			_feedHistory[metrics.url] = list = [NSMutableArray arrayWithCapacity:kMetricsHistoryPerFeed];
+		if (list.count >= kMetricsHistoryPerFeed)
+			[list removeObjectAtIndex:0];
+		[list addObject:metrics];
+		for (UpdateCycle *cycle in _openCycles)
+			[cycle.feeds addObject:metrics];
+	}
+}
+
+/// Start collecting feed metrics for an update cycle. @return Opaque token for @c endCycle:
++ (id)beginCycle {
+	UpdateCycle *cycle = [UpdateCycle new];
+	cycle.start = [NSDate date];
+	cycle.feeds = [NSMutableArray array];
+	cycle.skippedConversions = [FeedArticle skippedConversions];
+	cycle.faviconBytesSaved = [FaviconDownload bytesSaved];
+	@synchronized (self) {
+		if (!_openCycles)
+			_openCycles = [NSMutableArray array];
+		[_openCycles addObject:cycle];
+	}
+	return cycle;
+}
+
+/// Stop collecting feed metrics and store aggregated cycle summary.
++ (void)endCycle:(id)cycle {
+	@synchronized (self) {
+		[_openCycles removeObjectIdenticalTo:cycle];
+		if (!_cycleHistory)
+			_cycleHistory = [NSMutableArray arrayWithCapacity:kMetricsHistoryCycles];
+		if (_cycleHistory.count >= kMetricsHistoryCycles)
+			[_cycleHistory removeObjectAtIndex:0];
+		[_cycleHistory addObject:[self summaryForCycle:cycle]];
+	}
+}
+
+/**
+ @return Sum of all stages, number of unchanged and failed feeds, and the slowest feeds of @c cycle .
+ Also, number of articles where HTML conversion was skipped (unchanged content digest)
+ and number of bytes not downloaded because favicon HTML pages were stopped after @c </head> .
+ */
++ (NSDictionary*)summaryForCycle:(UpdateCycle*)cycle {
+	NSTimeInterval sum[4] = {0, 0, 0, 0};
+	NSUInteger unchanged = 0, failed = 0;
+	int64_t bytes = 0;
+	for (FeedUpdateMetrics *m in cycle.feeds) {
+		for (UpdateStage s = UpdateStageDownload; s <= UpdateStageSave; s++)
+			sum[s] += MAX(0, [m durationForStage:s]);
+		if (m.unchanged) ++unchanged;
+		if (m.failed) ++failed;
+		bytes += m.bytes;
+	}
+	NSArray<FeedUpdateMetrics*> *sorted = [cycle.feeds sortedArrayUsingComparator:^NSComparisonResult(FeedUpdateMetrics *a, FeedUpdateMetrics *b) {
+		return [@(b.total) compare:@(a.total)];
+	}];
+	NSMutableArray *slowest = [NSMutableArray arrayWithCapacity:kMetricsSlowestFeeds];
+	for (NSUInteger i = 0; i < MIN(kMetricsSlowestFeeds, sorted.count); i++)
+		[slowest addObject:@{ @"url": sorted[i].url, @"total": Millis(sorted[i].total) }];
+	return @{ @"date": ISODate(cycle.start),
+			  @"duration": Millis(-cycle.start.timeIntervalSinceNow),
+			  @"feeds": @(cycle.feeds.count),
+			  @"unchanged": @(unchanged),
+			  @"failed": @(failed),
+			  @"bytes": @(bytes),
+			  @"skippedConversions": @([FeedArticle skippedConversions] - cycle.skippedConversions),
+			  @"faviconBytesSaved": @([FaviconDownload bytesSaved] - cycle.faviconBytesSaved),
+			  @"download": Millis(sum[UpdateStageDownload]),
+			  @"parse": Millis(sum[UpdateStageParse]),
+			  @"reconcile": Millis(sum[UpdateStageReconcile]),
+			  @"save": Millis(sum[UpdateStageSave]),
+			  @"slowest": slowest };
+}
+
+/**
+ Aggregated metrics of all recorded updates for @c url (since app launch).
+ @return @c nil if feed was not updated yet. Else, keys @c count , @c avg , @c max (total in milliseconds) and @c last (see export).
+ */
++ (nullable NSDictionary*)summaryForFeed:(NSString*)url {
+	@synchronized (self) {
+		NSArray<FeedUpdateMetrics*> *list = _feedHistory[url];
+		if (list.count == 0)
+			return nil;
+		NSTimeInterval sum = 0, max = 0;
+		for (FeedUpdateMetrics *m in list) {
+			sum += m.total;
+			max = MAX(max, m.total);
+		}
+		return @{ @"count": @(list.count),
+				  @"avg": Millis(sum / list.count),
+				  @"max": Millis(max),
+				  @"last": [list.lastObject jsonObject] };
+	}
+}
+
+/// @return Complete report with all feed updates and update cycles. Can be serialized with @c NSJSONSerialization .
++ (NSDictionary*)report {
+	@synchronized (self) {
+		NSMutableDictionary *feeds = [NSMutableDictionary dictionaryWithCapacity:_feedHistory.count];
+		for (NSString *url in _feedHistory)
+			feeds[url] = [_feedHistory[url] valueForKey:@"jsonObject"];
+		return @{ @"generated": ISODate([NSDate date]),
+				  @"feeds": feeds,
+				  @"cycles": _cycleHistory ?: @[] };
+	}
+}
+
+/// Write @c report as pretty printed JSON file to @c url .
++ (nullable NSError*)writeReportToURL:(NSURL*)url {
+	NSError *err;
+	NSData *data = [NSJSONSerialization dataWithJSONObject:[self report] options:NSJSONWritingPrettyPrinted | NSJSONWritingSortedKeys error:&err];
+	if (data)
+		[data writeToURL:url options:NSDataWritingAtomic error:&err];
+	return err;
+}
+
+@end
@@ -6,6 +6,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface UpdateScheduler : NSObject
 @property (class, readonly) NSUInteger feedsInQueue;
+@property (class, readonly) NSUInteger feedsInFlight;
 @property (class, readonly) NSDate *dateScheduled;
 @property (class, readonly) BOOL allowNetworkConnection;
 @property (class, readonly) BOOL isUpdating;
@@ -18,6 +19,7 @@ NS_ASSUME_NONNULL_BEGIN
 + (void)scheduleNextFeed;
 + (void)forceUpdate:(NSString*)indexPath;
 + (void)downloadList:(NSArray<Feed*>*)list userInitiated:(BOOL)flag notifications:(BOOL)notify finally:(nullable os_block_t)block;
++ (void)downloadStagedList:(NSArray<Feed*>*)list finally:(nullable os_block_t)block;
 + (void)updateAllFavicons;
 // Auto Download & Parse Feed URL
 + (void)autoDownloadAndParseURL:(NSString*)url;
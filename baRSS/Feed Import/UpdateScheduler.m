@@ -6,6 +6,7 @@
 #import "NSDate+Ext.h"
 
 #import "FeedDownload.h"
+#import "UpdateMetrics.h"
 #import "FaviconDownload.h"
 #import "Feed+Ext.h"
 #import "FeedArticle+Ext.h"
@@ -20,14 +21,82 @@ static BOOL _isReachable = YES;
 static BOOL _updatePaused = NO;
 static _Atomic(NSUInteger) _queueSize = 0;
 
+/// Max number of simultaneous feed downloads.
+static NSUInteger const kMaxConcurrentDownloads = 6;
+/// Max number of simultaneous feed downloads to the same host.
+static NSUInteger const kMaxConcurrentDownloadsPerHost = 2;
+
+/// Single feed download waiting in (or running from) the download queue.
+@interface UpdateJob : NSObject
+@property (nonatomic, strong) Feed *feed;
+@property (nonatomic, strong) NSManagedObjectContext *ingest; // private queue context
+@property (nonatomic, copy) NSString *host;
+@property (nonatomic, assign) BOOL userInitiated;
+@property (nonatomic, assign) BOOL notify;
+@property (nonatomic, assign) NSTimeInterval overdue; // seconds since scheduled date
+@property (nonatomic, strong) os_block_t finally;
+@end
+
+@implementation UpdateJob
+/// Sort order of download queue. User initiated first, then most overdue first.
+- (NSComparisonResult)comparePriority:(UpdateJob*)other {
+	if (self.userInitiated != other.userInitiated)
+		return self.userInitiated ? NSOrderedAscending : NSOrderedDescending;
+	if (self.overdue != other.overdue)
+		return self.overdue > other.overdue ? NSOrderedAscending : NSOrderedDescending;
+	return NSOrderedSame;
+}
+@end
+
+/// Max number of merged feeds per batch commit.
+static NSUInteger const kCommitBatchSize = 20;
+/// Max delay (in seconds) until merged feeds are committed.
+static NSTimeInterval const kCommitWindow = 1.0;
+
+/// Merged feed waiting for the next batch commit.
+@interface PendingCommit : NSObject
+@property (nonatomic, strong) NSManagedObjectID *oid;
+@property (nonatomic, assign) BOOL notify; // post notifications for inserted articles (same for all feeds in context)
+@property (nonatomic, assign) BOOL articlesUpdated; // post kNotificationArticlesUpdated
+@property (nonatomic, assign) BOOL downloadIcon;
+@property (nonatomic, strong) FeedUpdateMetrics *metrics;
+@property (nonatomic, strong) os_block_t finally;
+@end
+
+@implementation PendingCommit
+@end
+
+// Download queue, accessed on main thread only
+static NSMutableArray<UpdateJob*> *_pendingJobs;
+static NSCountedSet<NSString*> *_activeHosts;
+static NSUInteger _inFlight = 0;
+// Batch commits, accessed on main thread only
+static NSMapTable<NSManagedObjectContext*, NSMutableArray<PendingCommit*>*> *_pendingCommits;
+static NSUInteger _pendingCommitCount = 0;
+#ifdef DEBUG
+static NSUInteger _commitCount = 0; // number of save transactions since last cycle
+static NSUInteger _unchangedCount = 0; // number of feeds with identical payload since last cycle
+#endif
+/// Number of feeds released per stage (see @c downloadStagedList:finally: ).
+static NSUInteger const kStagedDownloadSize = 20;
+/// Min. time (in seconds) between the release of two stages.
+static NSTimeInterval const kStagedDownloadInterval = 5.0;
+static NSUInteger _stagedCount = 0; // feeds waiting for release, accessed on main thread only
+/// Min. time (in seconds) between two runs of article retention pruning.
+static NSTimeInterval const kPruneInterval = 60 * 60;
+static NSDate *_lastPrune; // accessed on main thread only
+
 @implementation UpdateScheduler
 
 // ################################################################
 // #  MARK: - Getter & Setter -
 // ################################################################
 
-/// @return Number of feeds being currently downloaded.
-+ (NSUInteger)feedsInQueue { return _queueSize; }
+/// @return Number of feeds being currently downloaded, waiting in download queue, or waiting for staged release.
++ (NSUInteger)feedsInQueue { return _queueSize + _stagedCount; }
+
+/// @return Number of feeds being currently downloaded (limited by @c kMaxConcurrentDownloads ).
++ (NSUInteger)feedsInFlight { return _inFlight; }
 
 /// @return Date when background update will fire. If updates are paused, date is @c distantFuture.
 + (NSDate *)dateScheduled { return _timer.fireDate; }
@@ -66,7 +135,7 @@ static _Atomic(NSUInteger) _queueSize = 0;
 
 /// Update status. 'Updating X feeds …' or empty string if not updating.
 + (NSString*)updatingXFeeds {
-	NSUInteger c = _queueSize;
+	NSUInteger c = [self feedsInQueue];
 	switch (c) {
 		case 0:  return @"";
 		case 1:  return NSLocalizedString(@"Updating 1 feed …", nil);
@@ -142,11 +211,49 @@ static _Atomic(NSUInteger) _queueSize = 0;
 + (void)update:(NSArray<Feed*>*)list userInitiated:(BOOL)flag context:(NSManagedObjectContext*)moc {
 #ifdef DEBUG
 	NSLog(@"updating feeds: %ld (%@)", list.count, flag ? @"forced" : @"scheduled");
+	NSUInteger fetches = [StoreCoordinator fetchCount], faults = [StoreCoordinator faultCount];
+	NSUInteger skipped = [FeedArticle skippedConversions];
 #endif
+	id cycle = [UpdateMetrics beginCycle];
+	if (@available(macOS 10.14, *)) {
+		[NotifyEndpoint beginBatch]; // deliver all notifications of this cycle at once
+	}
 	[self downloadList:list userInitiated:flag notifications:YES finally:^{
 		[StoreCoordinator saveContext:moc andParent:YES]; // save parents too ...
+		[UpdateMetrics endCycle:cycle];
+		if (@available(macOS 10.14, *)) {
+			[NotifyEndpoint endBatch];
+		}
+#ifdef DEBUG
+		NSLog(@"update cycle finished: %ld feeds, %ld commits, %ld unchanged, %lu skipped conversions, %lu fetches, %lu faults",
+			  list.count, _commitCount, _unchangedCount, [FeedArticle skippedConversions] - skipped,
+			  [StoreCoordinator fetchCount] - fetches, [StoreCoordinator faultCount] - faults);
+		_commitCount = 0;
+		_unchangedCount = 0;
+#endif
 		[moc reset];
 		[self scheduleNextFeed]; // always reset the timer
+		[self pruneArticlesIfDue];
+	}];
+}
+
+/// Enforce article retention policy on background context. At most once per @c kPruneInterval .
++ (void)pruneArticlesIfDue {
+	if (_lastPrune && -_lastPrune.timeIntervalSinceNow < kPruneInterval)
+		return;
+	_lastPrune = [NSDate date];
+	NSManagedObjectContext *moc = [StoreCoordinator createBackgroundContext];
+	[moc performBlock:^{
+		NSUInteger pruned = [StoreCoordinator pruneArticlesInContext:moc];
+		if (pruned == 0)
+			return;
+		dispatch_async(dispatch_get_main_queue(), ^{
+#ifdef DEBUG
+			NSLog(@"pruned %ld articles", pruned);
+#endif
+			[StoreCoordinator restoreFeedCounts];
+			PostNotification(kNotificationTotalUnreadCountReset, nil);
+		});
 	}];
 }
 
@@ -160,7 +267,10 @@ static _Atomic(NSUInteger) _queueSize = 0;
 		[FaviconDownload updateFeed:f finally:nil];
 }
 
-/// Download list of feeds. Either silently in background or with alerts in foreground.
+/**
+ Download list of feeds. Either silently in background or with alerts in foreground.
+ Feeds are added to a shared download queue with limited concurrency (total and per host).
+ */
 + (void)downloadList:(NSArray<Feed*>*)list userInitiated:(BOOL)flag notifications:(BOOL)notify finally:(nullable os_block_t)block {
 	if (![self allowNetworkConnection]) {
 		if (block) block();
@@ -170,17 +280,109 @@ static _Atomic(NSUInteger) _queueSize = 0;
 	atomic_fetch_add_explicit(&_queueSize, list.count, memory_order_relaxed);
 	PostNotification(kNotificationBackgroundUpdateInProgress, @(_queueSize));
 	dispatch_group_t group = dispatch_group_create();
+	NSManagedObjectContext *ingest = [StoreCoordinator createBackgroundContext];
+	NSMutableArray<UpdateJob*> *jobs = [NSMutableArray arrayWithCapacity:list.count];
 	for (Feed *f in list) {
 		dispatch_group_enter(group);
-		[self updateFeed:f alert:flag isForced:flag notifications:notify finally:^{
+		UpdateJob *job = [UpdateJob new];
+		job.feed = f;
+		job.ingest = ingest;
+		job.host = [NSURL URLWithString:f.meta.url].host.lowercaseString ?: @"";
+		job.userInitiated = flag;
+		job.notify = notify;
+		job.overdue = (f.meta.scheduled ? -f.meta.scheduled.timeIntervalSinceNow : 0);
+		job.finally = ^{
 			atomic_fetch_sub_explicit(&_queueSize, 1, memory_order_relaxed);
 			PostNotification(kNotificationBackgroundUpdateInProgress, @(_queueSize));
 			dispatch_group_leave(group);
-		}];
+		};
+		[jobs addObject:job];
 	}
+	[self enqueueJobs:jobs];
 	if (block) dispatch_group_notify(group, dispatch_get_main_queue(), block);
 }
 
+/**
+ Download a (possibly huge) list of newly added feeds. Feeds are released in stages of @c kStagedDownloadSize .
+ The next stage starts after the previous one finished, but not before @c kStagedDownloadInterval seconds passed.
+ Short lists are downloaded as user initiated (with error alerts). Long lists are downloaded silently.
+ */
++ (void)downloadStagedList:(NSArray<Feed*>*)list finally:(nullable os_block_t)block {
+	if (list.count <= kStagedDownloadSize || ![self allowNetworkConnection]) {
+		[self downloadList:list userInitiated:YES notifications:NO finally:block];
+		return;
+	}
+	_stagedCount += list.count;
+	[self releaseStage:list from:0 finally:block];
+}
+
+/// Release next @c kStagedDownloadSize feeds of @c list to the download queue.
++ (void)releaseStage:(NSArray<Feed*>*)list from:(NSUInteger)start finally:(nullable os_block_t)block {
+	NSUInteger end = MIN(start + kStagedDownloadSize, list.count);
+	NSArray<Feed*> *stage = [list subarrayWithRange:NSMakeRange(start, end - start)];
+	_stagedCount -= stage.count;
+	NSDate *released = [NSDate date];
+	[self downloadList:stage userInitiated:NO notifications:NO finally:^{
+		if (end >= list.count) {
+			if (block) block();
+			return;
+		}
+		NSTimeInterval wait = MAX(0, kStagedDownloadInterval + released.timeIntervalSinceNow);
+		dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(wait * NSEC_PER_SEC)), dispatch_get_main_queue(), ^{
+			[self releaseStage:list from:end finally:block];
+		});
+	}];
+}
+
+/// Insert jobs into download queue (sorted by priority) and start as many as allowed.
++ (void)enqueueJobs:(NSArray<UpdateJob*>*)jobs {
+	if (!_pendingJobs) {
+		_pendingJobs = [NSMutableArray array];
+		_activeHosts = [NSCountedSet set];
+	}
+	[_pendingJobs addObjectsFromArray:jobs];
+	[_pendingJobs sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(UpdateJob *a, UpdateJob *b) {
+		return [a comparePriority:b];
+	}];
+	[self startPendingJobs];
+}
+
+/**
+ Start queued jobs in priority order until concurrency limit is reached. Skip jobs whose host is busy.
+ If network is unreachable or updates are paused, all queued jobs are dropped (feeds stay scheduled for the next update).
+ */
++ (void)startPendingJobs {
+	NSUInteger i = 0;
+	while (i < _pendingJobs.count && _inFlight < kMaxConcurrentDownloads) {
+		if (![self allowNetworkConnection]) {
+			[self dropPendingJobs];
+			return;
+		}
+		UpdateJob *job = _pendingJobs[i];
+		if ([_activeHosts countForObject:job.host] >= kMaxConcurrentDownloadsPerHost) {
+			++i;
+			continue;
+		}
+		[_pendingJobs removeObjectAtIndex:i];
+		_inFlight += 1;
+		[_activeHosts addObject:job.host];
+		[self updateFeed:job.feed ingest:job.ingest alert:job.userInitiated isForced:job.userInitiated notifications:job.notify processed:^{
+			_inFlight -= 1;
+			[_activeHosts removeObject:job.host];
+			[self startPendingJobs];
+		} finally:job.finally];
+	}
+}
+
+/// Remove all queued (not started) jobs and call their @c finally block. Running downloads are not affected.
++ (void)dropPendingJobs {
+	NSArray<UpdateJob*> *dropped = [_pendingJobs copy];
+	[_pendingJobs removeAllObjects];
+	for (UpdateJob *job in dropped) {
+		if (job.finally) job.finally();
+	}
+}
+
 /// Helper method to show modal error alert
 static inline void AlertDownloadError(NSError *err, NSString *url) {
 	NSAlert *alertPopup = [NSAlert alertWithError:err];
@@ -190,24 +392,94 @@ static inline void AlertDownloadError(NSError *err, NSString *url) {
 
 /**
  Start download request with existing @c Feed object. Reuses etag and modified headers (unless articles count is 0).
+ Articles are merged on private queue context @c ingest and collected for the next batch commit (see @c flushCommits: ).
  @note Will post a @c kNotificationArticlesUpdated notification if download was successful and status code is @b not 304.
+ 
+ @param feed Must be saved already (permanent object ID). Used to prepare download request only.
+ @param processed Called on main thread once feed is downloaded and merged (before commit). Used to release download slot.
+ @param block Called on main thread after feed was committed (and favicon downloaded, if needed).
  */
-+ (void)updateFeed:(Feed*)feed alert:(BOOL)alert isForced:(BOOL)forced notifications:(BOOL)notify finally:(nullable os_block_t)block {
-	NSManagedObjectContext *moc = feed.managedObjectContext;
++ (void)updateFeed:(Feed*)feed ingest:(NSManagedObjectContext*)ingest alert:(BOOL)alert isForced:(BOOL)forced notifications:(BOOL)notify processed:(nullable os_block_t)processed finally:(nullable os_block_t)block {
 	NSManagedObjectID *oid = feed.objectID;
 	[[FeedDownload withFeed:feed forced:forced] startWithBlock:^(FeedDownload *mem) {
 		if (alert && mem.error) // but still copy values for error count increment
 			AlertDownloadError(mem.error, mem.request.URL.absoluteString);
-		Feed *f = [moc objectWithID:oid];
-		BOOL recentlyAdded = (f.articles.count == 0); // before copy values
-		BOOL downloadIcon = (!f.hasIcon && (recentlyAdded || forced));
-		BOOL needsNotification = [mem copyValuesTo:f ignoreError:NO];
-		
+		[ingest performBlock:^{
+			Feed *f = [ingest objectWithID:oid];
+			BOOL recentlyAdded = (f.totalCount == 0); // before copy values
+			NSInteger unreadDiff = 0;
+			PendingCommit *pc = [PendingCommit new];
+			pc.oid = oid;
+			pc.notify = notify;
+			pc.downloadIcon = (!f.hasIcon && (recentlyAdded || forced) && !mem.error);
+			pc.articlesUpdated = [mem copyValuesTo:f ignoreError:NO unreadDiff:&unreadDiff];
+			pc.metrics = mem.metrics;
+			pc.finally = block;
+			dispatch_async(dispatch_get_main_queue(), ^{
+#ifdef DEBUG
+				if (mem.unchanged) _unchangedCount += 1;
+#endif
+				if (unreadDiff != 0)
+					PostNotification(kNotificationTotalUnreadCountChanged, @(unreadDiff));
+				if (processed) processed();
+				[self addPendingCommit:pc inContext:ingest];
+			});
+		}];
+	}];
+}
+
+// ################################################################
+// #  MARK: - Batch Commit -
+// ################################################################
+
+/**
+ Append merged feed to batch. Flush immediatelly if batch size is reached or if no other feed is still downloading.
+ Otherwise, flush after @c kCommitWindow seconds at the latest.
+ */
++ (void)addPendingCommit:(PendingCommit*)pc inContext:(NSManagedObjectContext*)moc {
+	if (!_pendingCommits)
+		_pendingCommits = [NSMapTable strongToStrongObjectsMapTable];
+	NSMutableArray<PendingCommit*> *batch = [_pendingCommits objectForKey:moc];
+	if (!batch) {
+		batch = [NSMutableArray arrayWithCapacity:kCommitBatchSize];
+		[_pendingCommits setObject:batch forKey:moc];
+		[self performSelector:@selector(flushCommits:) withObject:moc afterDelay:kCommitWindow inModes:@[NSRunLoopCommonModes]];
+	}
+	[batch addObject:pc];
+	_pendingCommitCount += 1;
+	if (batch.count >= kCommitBatchSize) {
+		[self flushCommits:moc];
+	} else if (_pendingCommitCount >= _queueSize) { // every remaining feed is waiting for commit
+		for (NSManagedObjectContext *other in [[_pendingCommits keyEnumerator] allObjects])
+			[self flushCommits:other];
+	}
+}
+
+/**
+ Save all merged feeds of private queue context @c moc in a single transaction.
+ Afterwards, dismiss and post notifications, post @c kNotificationArticlesUpdated and call @c finally blocks (in order).
+ Only object IDs are handed back to the main thread. Main context merges saved changes automatically.
+ */
++ (void)flushCommits:(NSManagedObjectContext*)moc {
+	[NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(flushCommits:) object:moc];
+	NSArray<PendingCommit*> *batch = [_pendingCommits objectForKey:moc];
+	if (!batch)
+		return;
+	[_pendingCommits removeObjectForKey:moc];
+	_pendingCommitCount -= batch.count;
+	
+	[moc performBlock:^{
 		// need to gather object before save, because afterwards list will be empty
-		NSArray *inserted = notify ? moc.insertedObjects.allObjects : nil;
+		NSArray *inserted = moc.insertedObjects.allObjects;
 		NSArray *deleted = moc.deletedObjects.allObjects;
 		
+		for (PendingCommit *pc in batch)
+			[pc.metrics begin:UpdateStageSave]; // shared transaction, same duration for all feeds in batch
 		[StoreCoordinator saveContext:moc andParent:YES];
+		for (PendingCommit *pc in batch) {
+			[pc.metrics end:UpdateStageSave];
+			if (pc.metrics) [UpdateMetrics record:pc.metrics];
+		}
 		
 		// after save, update notifications
 		// dismiss previously delivered notifications
@@ -222,24 +494,38 @@ static inline void AlertDownloadError(NSError *err, NSString *url) {
 				[NotifyEndpoint dismiss:ids]; // no-op if empty
 			}
 			// post new notification (if needed)
-			if (notify && inserted) {
-				BOOL didAddAny = NO;
-				for (FeedArticle *article in inserted) { // will contain non-articles too
-					if ([article isKindOfClass:[FeedArticle class]]) {
-						[NotifyEndpoint postArticle:article];
-						didAddAny = YES;
-					}
+			// Group by feed: save may include feeds which were merged after batch was closed (same context = same flag)
+			NSMutableDictionary<NSManagedObjectID*, NSMutableArray<FeedArticle*>*> *byFeed = [NSMutableDictionary dictionary];
+			for (FeedArticle *article in inserted) { // will contain non-articles too
+				if ([article isKindOfClass:[FeedArticle class]] && article.feed) {
+					NSManagedObjectID *feedID = article.feed.objectID;
+					if (!byFeed[feedID]) byFeed[feedID] = [NSMutableArray array];
+					[byFeed[feedID] addObject:article];
 				}
-				if (didAddAny)
-					[NotifyEndpoint postFeed:f];
+			}
+			if (batch.firstObject.notify) {
+				[byFeed enumerateKeysAndObjectsUsingBlock:^(NSManagedObjectID *feedID, NSArray<FeedArticle*> *articles, BOOL *stop) {
+					for (FeedArticle *article in articles)
+						[NotifyEndpoint postArticle:article];
+					[NotifyEndpoint postFeed:[moc objectWithID:feedID]];
+				}];
 			}
 		}
+		[moc reset]; // free memory, next batch will fault objects again
 		
-		if (needsNotification)
-			PostNotification(kNotificationArticlesUpdated, oid);
-		if (downloadIcon && !mem.error) {
-			[FaviconDownload updateFeed:f finally:block];
-		} else if (block) block(); // always call block(); with or without favicon download
+		dispatch_async(dispatch_get_main_queue(), ^{
+#ifdef DEBUG
+			_commitCount += 1;
+#endif
+			NSManagedObjectContext *main = [StoreCoordinator getMainContext];
+			for (PendingCommit *pc in batch) {
+				if (pc.articlesUpdated)
+					PostNotification(kNotificationArticlesUpdated, pc.oid);
+				if (pc.downloadIcon) {
+					[FaviconDownload updateFeed:[main objectWithID:pc.oid] finally:pc.finally];
+				} else if (pc.finally) pc.finally(); // always call block(); with or without favicon download
+			}
+		});
 	}];
 }
 
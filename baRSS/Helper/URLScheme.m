@@ -6,6 +6,12 @@
 #import "OpmlFile.h" // barss:backup
 #import "NSURL+Ext.h" // barss:backup
 #import "NSDate+Ext.h" // barss:backup
+#import "UpdateMetrics.h" // barss:metrics
+#import "IngestBenchmark.h" // barss:config/benchmark/ingest
+#import "Feed+Ext.h" // barss:config/benchmark/reconcile
+#import "RegexFeed.h" // barss:config/benchmark/regex
+#import "MapUnreadTotal.h" // barss:config/benchmark/unread
+#import "NSString+Ext.h" // barss:config/benchmark/html
 
 @implementation URLScheme
 
@@ -32,7 +38,14 @@
        @textblock
  barss:open/preferences[/0-4]
  barss:config/fixcache[/silent]
+ barss:config/benchmark (DEBUG only)
+ barss:config/benchmark/ingest[/feeds=200/rounds=3/latency=30/errors=0.02/changed=0.2] (DEBUG only)
+ barss:config/benchmark/reconcile (DEBUG only)
+ barss:config/benchmark/regex (DEBUG only)
+ barss:config/benchmark/unread (DEBUG only)
+ barss:config/benchmark/html (DEBUG only)
  barss:backup[/show]
+ barss:metrics[/show]
        @/textblock
  */
 - (void)handleSchemeConfig:(NSString*)url {
@@ -43,6 +56,7 @@
 	if ([action isEqualToString:@"open"])         [self handleActionOpen:params];
 	else if ([action isEqualToString:@"config"])  [self handleActionConfig:params];
 	else if ([action isEqualToString:@"backup"])  [self handleActionBackup:params];
+	else if ([action isEqualToString:@"metrics"]) [self handleActionMetrics:params];
 }
 
 /// @c barss:open/preferences[/0-4]
@@ -53,11 +67,22 @@
 	}
 }
 
-/// @c barss:config/fixcache[/silent]
+/// @c barss:config/fixcache[/silent] and @c barss:config/benchmark[/ingest|reconcile|regex|unread|html]
 - (void)handleActionConfig:(NSArray<NSString*>*)params {
 	if ([params.firstObject isEqualToString:@"fixcache"]) {
 		[StoreCoordinator cleanupAndShowAlert:![params.lastObject isEqualToString:@"silent"]];
 	}
+#ifdef DEBUG
+	else if ([params.firstObject isEqualToString:@"benchmark"]) {
+		NSString *which = (params.count > 1 ? params[1] : nil);
+		if ([which isEqualToString:@"ingest"])         [IngestBenchmark runWithParameters:params];
+		else if ([which isEqualToString:@"reconcile"]) [Feed benchmarkReconcile];
+		else if ([which isEqualToString:@"regex"])     [RegexFeed benchmarkLargePage];
+		else if ([which isEqualToString:@"unread"])    [MapUnreadTotal benchmark];
+		else if ([which isEqualToString:@"html"])      [NSString benchmarkPlainText];
+		else                                           [StoreCoordinator benchmarkQueries];
+	}
+#endif
 }
 
 /// @c barss:backup[/show]
@@ -68,8 +93,24 @@
 	NSURL *sym = [baseURL file:@"feeds_latest" ext:@"opml"];
 	[sym remove]; // remove old sym link, otherwise won't be updated
 	[[NSFileManager defaultManager] createSymbolicLinkAtURL:sym withDestinationURL:[NSURL URLWithString:dest.lastPathComponent] error:nil];
-	[[OpmlFileExport withDelegate:nil] writeOPMLFile:dest withOptions:OpmlFileExportOptionFullBackup];
-	if ([params.firstObject isEqualToString:@"show"]) {
+	BOOL show = [params.firstObject isEqualToString:@"show"];
+	// Export on background context, no alerts
+	NSManagedObjectContext *moc = [StoreCoordinator createBackgroundContext];
+	[moc performBlock:^{
+		NSError *err = [[OpmlFileExport withDelegate:nil] writeOPMLFile:dest withOptions:OpmlFileExportOptionFullBackup | OpmlFileExportOptionHeadless inContext:moc];
+		if (show && !err) {
+			dispatch_async(dispatch_get_main_queue(), ^{
+				[[NSWorkspace sharedWorkspace] activateFileViewerSelectingURLs:@[dest]];
+			});
+		}
+	}];
+}
+
+/// @c barss:metrics[/show]
+- (void)handleActionMetrics:(NSArray<NSString*>*)params {
+	NSURL *dest = [[NSURL applicationSupportURL] file:@"update-metrics" ext:@"json"];
+	NSError *err = [UpdateMetrics writeReportToURL:dest];
+	if (!err && [params.firstObject isEqualToString:@"show"]) {
 		[[NSWorkspace sharedWorkspace] activateFileViewerSelectingURLs:@[dest]];
 	}
 }
@@ -47,6 +47,10 @@
 /** default: @c  2k */ static NSString* const Pref_articleTooltipLimit    = @"articleTooltipLimit";
 // ------ Hidden preferences ------ only modifiable via `defaults write de.relikd.baRSS {KEY}` ------
 /** default: @c  10 */ static NSString* const Pref_openFewLinksLimit      = @"openFewLinksLimit";
+/** default: @c   0 */ static NSString* const Pref_feedArticleLimit      = @"feedArticleLimit";
+/** default: @c   0 */ static NSString* const Pref_retainArticleCount    = @"retainArticleCount";
+/** default: @c   0 */ static NSString* const Pref_retainArticleDays     = @"retainArticleDays";
+/** default: @c  NO */ static NSString* const Pref_retainUnread          = @"retainUnread";
 /** default: @c nil */ static NSString* const Pref_colorStatusIconTint    = @"colorStatusIconTint";
 /** default: @c nil */ static NSString* const Pref_colorUnreadIndicator   = @"colorUnreadIndicator";
 
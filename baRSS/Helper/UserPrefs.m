@@ -24,9 +24,13 @@ void UserPrefsInit(void) {
 		Pref_globalToggleHidden,
 		Pref_groupUnreadOnly, Pref_feedUnreadOnly, Pref_articleUnreadOnly,
 		Pref_groupUnreadIndicator, Pref_feedUnreadIndicator,
+		Pref_retainUnread,
 	]);
 	// Display limits & truncation  ( defaults write de.relikd.baRSS {KEY} -int 10 )
 	[defs setObject:[NSNumber numberWithUnsignedInteger:10] forKey:Pref_openFewLinksLimit];
+	[defs setObject:[NSNumber numberWithUnsignedInteger:0] forKey:Pref_feedArticleLimit]; // 0: no limit
+	[defs setObject:[NSNumber numberWithUnsignedInteger:0] forKey:Pref_retainArticleCount]; // 0: no limit
+	[defs setObject:[NSNumber numberWithUnsignedInteger:0] forKey:Pref_retainArticleDays]; // 0: no limit
 	[defs setObject:[NSNumber numberWithInteger:-1] forKey:Pref_articleCountLimit];
 	[defs setObject:[NSNumber numberWithInteger:-1] forKey:Pref_articleTitleLimit];
 	[defs setObject:[NSNumber numberWithInteger:2000] forKey:Pref_articleTooltipLimit];
@@ -91,13 +91,21 @@ static TimeUnitType const _values[] = {
 
 @implementation NSDate (RefreshControlsUI)
 
-/// @return Interval by multiplying the text field value with the currently selected popup unit.
+/// @return Interval by multiplying the text field value with the currently selected popup unit. Negative tags are returned as is.
 + (Interval)intervalForPopup:(NSPopUpButton*)unit andField:(NSTextField*)value {
+	if (unit.selectedTag < 0) // special value, e.g., automatic
+		return (Interval)unit.selectedTag;
 	return value.intValue * (Interval)unit.selectedTag;
 }
 
 /// Configure both @c NSControl elements based on the provided interval @c intv.
 + (void)setInterval:(Interval)intv forPopup:(NSPopUpButton*)popup andField:(NSTextField*)field animate:(BOOL)flag {
+	if (intv < 0 && [popup indexOfItemWithTag:intv] >= 0) { // special value, e.g., automatic
+		[popup selectItemWithTag:intv];
+		field.stringValue = @"";
+		return;
+	}
+	intv = MAX(0, intv); // other negative values are deactivated updates
 	TimeUnitType unit = [self unitForInterval:intv];
 	int num = (int)(intv / unit);
 	if (flag && popup.selectedTag != unit) [self animateControlSize:popup];
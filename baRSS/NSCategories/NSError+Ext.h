@@ -10,6 +10,7 @@ NS_ASSUME_NONNULL_BEGIN
 + (instancetype)statusCode:(NSInteger)code reason:(nullable NSString*)reason;
 + (instancetype)feedURLNotFound:(NSURL*)url;
 + (instancetype)canceledByUser;
++ (instancetype)regexBudgetExceeded:(NSString*)field;
 //+ (instancetype)formattingError:(NSString*)description;
 // User notification
 - (BOOL)inCaseLog:(nullable const char*)title;
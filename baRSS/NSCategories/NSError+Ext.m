@@ -103,6 +103,15 @@ static const char* CodeDescription(NSInteger code) {
 	return [NSError errorWithDomain:NSCocoaErrorDomain code:NSUserCancelledError userInfo:nil];
 }
 
+/// Generate @c NSError for regex evaluation that took too long. @c field is the name of the aborted pattern.
++ (instancetype)regexBudgetExceeded:(NSString*)field {
+	NSDictionary *info = @{
+		NSLocalizedDescriptionKey: NSLocalizedString(@"Regex evaluation was aborted.", nil),
+		NSLocalizedRecoverySuggestionErrorKey: [NSString stringWithFormat:NSLocalizedString(@"A single match of the %@ pattern exceeded its time limit. Avoid nested quantifiers like '(.*)*' which cause catastrophic backtracking.", nil), field]
+	};
+	return [NSError errorWithDomain:NSCocoaErrorDomain code:NSExecutableRuntimeMismatchError userInfo:info];
+}
+
 /*// Generate @c NSError for invalid or malformed input. With title "The value is invalid."
 + (instancetype)formattingError:(NSString*)description {
 	NSDictionary *info = nil;
@@ -5,6 +5,9 @@ NS_ASSUME_NONNULL_BEGIN
 @interface NSString (PlainHTML)
 + (NSString*)plainTextFromHTMLData:(NSData*)data;
 - (nonnull NSString*)htmlToPlainText;
+#ifdef DEBUG
++ (void)benchmarkPlainText;
+#endif
 @end
 
 @interface NSString (HexColor)
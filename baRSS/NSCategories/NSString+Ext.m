@@ -1,18 +1,360 @@
 #import "NSString+Ext.h"
+#import "Constants.h"
+
+#pragma mark - Plain Text Converter
+
+
+/// Output buffer of @c PlainTextFromHTML(). Tracks trailing whitespace to collapse whitespace inline.
+typedef struct {
+	char *bytes;
+	size_t len, cap;
+	BOOL lastIsSpace;
+} PlainTextBuffer;
+
+/// Named HTML entities. All other entities must be numeric (e.g., @c &#8230; or @c &#x2026; ).
+static const struct { const char *name; const char *utf8; } _entities[] = {
+	{"amp", "&"}, {"lt", "<"}, {"gt", ">"}, {"quot", "\""}, {"apos", "'"},
+	{"nbsp", " "}, {"shy", "­"}, {"ensp", " "}, {"emsp", " "}, {"thinsp", " "},
+	{"ndash", "–"}, {"mdash", "—"}, {"hellip", "…"}, {"bull", "•"}, {"middot", "·"},
+	{"lsquo", "‘"}, {"rsquo", "’"}, {"sbquo", "‚"}, {"ldquo", "“"}, {"rdquo", "”"},
+	{"bdquo", "„"}, {"laquo", "«"}, {"raquo", "»"}, {"copy", "©"}, {"reg", "®"},
+	{"trade", "™"}, {"euro", "€"}, {"deg", "°"}, {"times", "×"},
+	{"auml", "ä"}, {"ouml", "ö"}, {"uuml", "ü"}, {"Auml", "Ä"}, {"Ouml", "Ö"},
+	{"Uuml", "Ü"}, {"szlig", "ß"}, {"eacute", "é"}, {"egrave", "è"}, {"agrave", "à"},
+};
+
+/// Same as regex @c \\h (tab and unicode space separators)
+static inline BOOL IsHorizontalSpace(uint32_t c) {
+	return c == ' ' || c == '\t' || c == 0xA0 || c == 0x1680 || (c >= 0x2000 && c <= 0x200A) || c == 0x202F || c == 0x205F || c == 0x3000;
+}
+
+/// Same as @c NSCharacterSet.newlineCharacterSet
+static inline BOOL IsNewline(uint32_t c) {
+	return (c >= 0x0A && c <= 0x0D) || c == 0x85 || c == 0x2028 || c == 0x2029;
+}
+
+/// Replacement character @c U+FFFD , returned by @c UTF8Decode() for invalid sequences.
+static uint32_t const kInvalidCodePoint = 0xFFFD;
+
+/**
+ Decode single UTF-8 character. Invalid sequences (including overlong encodings and surrogates) are consumed
+ byte by byte and returned as @c kInvalidCodePoint with @c n @c = @c 1 . @param n Number of bytes consumed.
+ */
+static inline uint32_t UTF8Decode(const unsigned char *s, size_t avail, size_t *n) {
+	unsigned char c = s[0];
+	*n = 1;
+	if (c < 0x80) return c;
+	size_t len = (c >> 5) == 0x6 ? 2 : (c >> 4) == 0xE ? 3 : (c >> 3) == 0x1E ? 4 : 0;
+	if (len == 0 || len > avail) return kInvalidCodePoint;
+	uint32_t cp = c & (0x7F >> len);
+	for (size_t i = 1; i < len; i++) {
+		if ((s[i] & 0xC0) != 0x80) return kInvalidCodePoint;
+		cp = (cp << 6) | (s[i] & 0x3F);
+	}
+	static uint32_t const minValue[] = { 0, 0, 0x80, 0x800, 0x10000 };
+	if (cp < minValue[len] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+		return kInvalidCodePoint;
+	*n = len;
+	return cp;
+}
+
+/// Encode unicode code point @c cp into @c dst (at least 4 bytes). @return Number of bytes written.
+static inline size_t UTF8Encode(uint32_t cp, char *dst) {
+	if (cp < 0x80)    { dst[0] = (char)cp; return 1; }
+	if (cp < 0x800)   { dst[0] = (char)(0xC0 | (cp >> 6)); dst[1] = (char)(0x80 | (cp & 0x3F)); return 2; }
+	if (cp < 0x10000) { dst[0] = (char)(0xE0 | (cp >> 12)); dst[1] = (char)(0x80 | ((cp >> 6) & 0x3F)); dst[2] = (char)(0x80 | (cp & 0x3F)); return 3; }
+	dst[0] = (char)(0xF0 | (cp >> 18)); dst[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+	dst[2] = (char)(0x80 | ((cp >> 6) & 0x3F)); dst[3] = (char)(0x80 | (cp & 0x3F));
+	return 4;
+}
+
+/// Append single character (@c n bytes). Consecutive horizontal whitespace is collapsed into the first one.
+static inline void BufferAppend(PlainTextBuffer *b, const char *src, size_t n, BOOL isSpace) {
+	if (isSpace && b->lastIsSpace)
+		return;
+	if (b->len + n > b->cap) {
+		while (b->len + n > b->cap) b->cap *= 2;
+		b->bytes = realloc(b->bytes, b->cap);
+	}
+	memcpy(b->bytes + b->len, src, n);
+	b->len += n;
+	b->lastIsSpace = isSpace;
+}
+
+/// Append null-terminated UTF-8 string character by character.
+static inline void BufferAppendString(PlainTextBuffer *b, const char *str) {
+	const unsigned char *s = (const unsigned char*)str;
+	size_t len = strlen(str), n;
+	for (size_t i = 0; i < len; i += n) {
+		uint32_t cp = UTF8Decode(s + i, len - i, &n);
+		BufferAppend(b, str + i, n, IsHorizontalSpace(cp));
+	}
+}
+
+/// Decode HTML entity starting with @c & and append to buffer. @return Number of bytes consumed or @c 0 if not an entity.
+static size_t BufferAppendEntity(PlainTextBuffer *b, const unsigned char *s, size_t avail) {
+	size_t end = 1;
+	while (end < avail && end < 12 && s[end] != ';' && s[end] != '&' && s[end] != '<')
+		++end;
+	if (end >= avail || s[end] != ';' || end < 3)
+		return 0;
+	if (s[1] == '#') {
+		BOOL hex = (s[2] == 'x' || s[2] == 'X');
+		uint32_t cp = 0;
+		size_t i = hex ? 3 : 2;
+		if (i == end) return 0;
+		for (; i < end; i++) {
+			unsigned char c = s[i];
+			if (c >= '0' && c <= '9')      cp = cp * (hex ? 16 : 10) + (c - '0');
+			else if (hex && c >= 'a' && c <= 'f') cp = cp * 16 + (c - 'a' + 10);
+			else if (hex && c >= 'A' && c <= 'F') cp = cp * 16 + (c - 'A' + 10);
+			else return 0;
+			if (cp > 0x10FFFF) cp = 0x110000; // clamp, prevent overflow (rejected below)
+		}
+		if (cp == 0 || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+			return 0;
+		char utf8[4];
+		BufferAppend(b, utf8, UTF8Encode(cp, utf8), IsHorizontalSpace(cp));
+		return end + 1;
+	}
+	for (size_t i = 0; i < sizeof(_entities) / sizeof(_entities[0]); i++) {
+		const char *name = _entities[i].name;
+		if (strlen(name) == end - 1 && strncmp(name, (const char*)s + 1, end - 1) == 0) {
+			BufferAppendString(b, _entities[i].utf8);
+			return end + 1;
+		}
+	}
+	return 0;
+}
+
+/// @return @c YES if @c tag matches @c name exactly or is followed by whitespace or @c / (case-insensitive).
+static inline BOOL TagIs(const unsigned char *tag, size_t len, const char *name) {
+	size_t n = strlen(name);
+	if (len < n || strncasecmp((const char*)tag, name, n) != 0)
+		return NO;
+	return len == n || tag[n] == ' ' || tag[n] == '/' || tag[n] == '\t' || tag[n] == '\n' || tag[n] == '\r';
+}
+
+/// @return @c YES if @c tag is a heading. Opening or closing, @c h1 - @c h6
+static inline BOOL TagIsHeading(const unsigned char *tag, size_t len) {
+	if (len > 0 && tag[0] == '/') { ++tag; --len; }
+	if (len < 2 || (tag[0] != 'h' && tag[0] != 'H') || tag[1] < '1' || tag[1] > '6')
+		return NO;
+	return len == 2 || tag[2] == ' ' || tag[2] == '/' || tag[2] == '\t' || tag[2] == '\n' || tag[2] == '\r';
+}
+
+/**
+ Single pass state machine that operates directly on UTF-8 bytes.
+ Text between tags is copied, entities are decoded, and horizontal whitespace is collapsed while writing.
+ Invalid UTF-8 sequences are replaced with @c U+FFFD .
+ 
+ Same as the previous @c NSScanner implementation: newlines directly after @c < or @c > are dropped.
+ A stray @c < (inside a tag) ends the current tag and is copied to the output.
+ 
+ @return @c nil if buffer allocation failed.
+ */
+static NSString* PlainTextFromHTML(const char *html, size_t len) {
+	const unsigned char *s = (const unsigned char*)html;
+	PlainTextBuffer out = { malloc(len + 64), 0, len + 64, NO };
+	if (!out.bytes) return nil;
+	BufferAppend(&out, " ", 1, YES);
+	const char *skip = NULL; // closing tag of head, style, script
+	int order = 0; // ul & ol
+	BOOL textStart = YES; // drop newlines directly after a tag
+	size_t i = 0, n;
+	while (i < len) {
+		unsigned char c = s[i];
+		if (c == '<') {
+			const unsigned char *tag = s + i + 1;
+			size_t end = i + 1;
+			while (end < len && s[end] != '>' && s[end] != '<') // stray '<' starts a new tag
+				++end;
+			BOOL stray = (end < len && s[end] == '<');
+			i = stray ? end : end + 1;
+			textStart = YES;
+			while (tag < s + end && *tag >= 0x0A && *tag <= 0x0D) // newlines are skipped at start of tag name
+				++tag;
+			size_t tagLen = (size_t)(s + end - tag);
+			// parse html tag depending on type
+			if (skip) {
+				// skip everything between <head>, <style>, and <script> tags
+				if (TagIs(tag, tagLen, skip))
+					skip = NULL;
+			}
+			else if (TagIs(tag, tagLen, "a"))      BufferAppend(&out, " ", 1, YES);
+			else if (TagIs(tag, tagLen, "head"))   skip = "/head";
+			else if (TagIs(tag, tagLen, "style"))  skip = "/style";
+			else if (TagIs(tag, tagLen, "script")) skip = "/script";
+			else if (TagIs(tag, tagLen, "/p") || TagIs(tag, tagLen, "label") || TagIs(tag, tagLen, "br") || TagIsHeading(tag, tagLen))
+				BufferAppend(&out, "\n", 1, NO);
+			else if (TagIs(tag, tagLen, "ol")) order = 1;
+			else if (TagIs(tag, tagLen, "ul")) order = 0;
+			else if (TagIs(tag, tagLen, "li")) {
+				// ordered and unordered list items
+				if (out.bytes[out.len - 1] != '\n')
+					BufferAppend(&out, "\n", 1, NO);
+				if (order > 0) {
+					char num[16];
+					snprintf(num, sizeof(num), " %d. ", order++);
+					BufferAppendString(&out, num);
+				} else {
+					BufferAppendString(&out, " • ");
+				}
+			}
+			if (stray && !skip)
+				BufferAppend(&out, "<", 1, NO);
+			continue;
+		}
+		uint32_t cp = UTF8Decode(s + i, len - i, &n);
+		if (textStart && IsNewline(cp)) {
+			i += n;
+			continue;
+		}
+		textStart = NO;
+		if (!skip) {
+			size_t consumed = (c == '&') ? BufferAppendEntity(&out, s + i, len - i) : 0;
+			if (consumed > 0) {
+				i += consumed;
+				continue;
+			}
+			if (cp == kInvalidCodePoint && n == 1)
+				BufferAppend(&out, "\xEF\xBF\xBD", 3, NO);
+			else
+				BufferAppend(&out, html + i, n, IsHorizontalSpace(cp));
+		}
+		if (c == '>')
+			textStart = YES;
+		i += n;
+	}
+	// trim trailing whitespace (except space, used for "li")
+	while (out.len > 1) {
+		size_t start = out.len - 1;
+		while (start > 0 && (out.bytes[start] & 0xC0) == 0x80)
+			--start;
+		uint32_t cp = UTF8Decode((const unsigned char*)out.bytes + start, out.len - start, &n);
+		if (cp == ' ' || !(IsHorizontalSpace(cp) || IsNewline(cp)))
+			break;
+		out.len = start;
+	}
+	NSString *result = [[NSString alloc] initWithBytesNoCopy:out.bytes length:out.len encoding:NSUTF8StringEncoding freeWhenDone:YES];
+	if (!result)
+		free(out.bytes);
+	return result;
+}
+
 
 @implementation NSString (PlainHTML)
 
-/// Init string with @c NSUTF8StringEncoding and call @c htmlToPlainText
+/// Convert UTF-8 encoded HTML data without intermediate string. See @c htmlToPlainText
 + (NSString*)plainTextFromHTMLData:(NSData*)data {
 	if (!data) return nil;
-	return [[[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding] htmlToPlainText];
+	return PlainTextFromHTML(data.bytes, data.length) ?: @"";
 }
 
 /**
  Simple HTML parser to extract TEXT elements and semi-structured elements like list items.
- Ignores @c <head> , @c <style> and @c <script> tags.
+ Ignores @c <head> , @c <style> and @c <script> tags. Decodes HTML entities and collapses horizontal whitespace.
  */
 - (nonnull NSString*)htmlToPlainText {
+	NSString *result;
+	const char *ascii = CFStringGetCStringPtr((__bridge CFStringRef)self, kCFStringEncodingUTF8); // no copy, usually ASCII only
+	if (ascii) {
+		result = PlainTextFromHTML(ascii, [self lengthOfBytesUsingEncoding:NSUTF8StringEncoding]);
+	} else {
+		// explicit length (embedded NUL), lone surrogates are replaced
+		NSData *data = [self dataUsingEncoding:NSUTF8StringEncoding allowLossyConversion:YES];
+		result = PlainTextFromHTML(data.bytes, data.length);
+	}
+	return result ? result : @"";
+}
+
+#ifdef DEBUG
+#pragma mark - Benchmark (DEBUG)
+
+/// Input and expected output of @c htmlToPlainText . Expected output is the same as the previous @c NSScanner implementation,
+/// except for: decoded entities, case-insensitive tag names, and tag names followed by any whitespace or @c / .
+/// In that case, the third value is the output of @c htmlToPlainTextLegacy .
+static const struct { const char *html, *text, *legacy; } _golden[] = {
+	{ "Plain text",
+	  " Plain text", NULL },
+	{ "  Collapse \t  horizontal    whitespace  ",
+	  " Collapse horizontal whitespace ", NULL },
+	{ "<p>First paragraph</p><p>Second paragraph</p>",
+	  " First paragraph\nSecond paragraph", NULL },
+	{ "<h1>Title</h1>Text<h2 class=\"x\">Sub</h2><h3>3</h3><h4>4</h4><h5>5</h5><h6>6</h6>end",
+	  " \nTitle\nText\nSub\n\n3\n\n4\n\n5\n\n6\nend", NULL },
+	{ "Line<br>break<br class=\"x\">end",
+	  " Line\nbreak\nend", NULL },
+	{ "<ul><li>one</li><li>two</li></ul>",
+	  " \n • one\n • two", NULL },
+	{ "<ol><li>one</li><li>two</li></ol><ul><li>three</li></ul>",
+	  " \n 1. one\n 2. two\n • three", NULL },
+	{ "<ol start=\"1\"><li class=\"a\">one<li>two</ol>",
+	  " \n 1. one\n 2. two", NULL },
+	{ "<p>\nText after newline</p>\n<p>\n\nmore</p>",
+	  " Text after newline\nmore", NULL },
+	{ "a<\nbr>b",
+	  " a\nb", NULL },
+	{ "<head><title>x</title></head>Visible",
+	  " Visible", NULL },
+	{ "<style>p { color: red; }</style>Visible<style type=\"text/css\">b{}</style> text",
+	  " Visible text", NULL },
+	{ "<script>var a = 1 < 2;</script>Visible<script src=\"x.js\"></script> text",
+	  " Visible text", NULL },
+	{ "<a href=\"https://example.org\">link</a>text<a>x</a>",
+	  " linktext x", NULL },
+	{ "<label>Label</label>value",
+	  " \nLabelvalue", NULL },
+	{ "a < b <i>x</i>",
+	  " a <x", NULL },
+	{ "<b class=\"x\" <i>text</i>",
+	  " <text", NULL },
+	{ "a << b",
+	  " a <", NULL },
+	{ "a >> b",
+	  " a >> b", NULL },
+	{ "<b>>bold</b>",
+	  " >bold", NULL },
+	{ "Trailing newlines<br><br>\n\n \t",
+	  " Trailing newlines\n\n ", NULL },
+	{ "<li>item</li>",
+	  " \n • item", NULL },
+	{ "&#x11111111; &#0; &#xD800; &#xZZ; &unknown; & alone &amp",
+	  " &#x11111111; &#0; &#xD800; &#xZZ; &unknown; & alone &amp", NULL },
+	// intended differences, third value is output of previous implementation
+	{ "Tom &amp; Jerry &lt;3 &quot;quoted&quot; &hellip; &nbsp;x",
+	  " Tom & Jerry <3 \"quoted\" … x",
+	  " Tom &amp; Jerry &lt;3 &quot;quoted&quot; &hellip; &nbsp;x" },
+	{ "&#8230; &#x2026; &#X2026; &#128512;",
+	  " … … … 😀",
+	  " &#8230; &#x2026; &#X2026; &#128512;" },
+	{ "Line<BR>break<P>text</P>upper<H1>Title</H1>",
+	  " Line\nbreaktext\nupper\nTitle",
+	  " LinebreaktextupperTitle" },
+	{ "<UL><LI>one</LI></UL><OL><LI>two</LI></OL>",
+	  " \n • one\n 1. two",
+	  " onetwo" },
+	{ "<SCRIPT>hidden</SCRIPT>visible<Head>x</Head>",
+	  " visible",
+	  " hiddenvisiblex" },
+	{ "Line<br/>break<br />and<br\tclass=\"x\">end",
+	  " Line\nbreak\nand\nend",
+	  " Linebreak\nandend" },
+	{ "<li\nclass=\"x\">item</li><h2\tid=\"x\">Sub</h2>",
+	  " \n • item\nSub",
+	  " itemSub" },
+};
+
+static inline BOOL OPEN(NSString *tag, NSString *match) {
+	return ([tag isEqualToString:match] || [tag hasPrefix:[match stringByAppendingString:@" "]]);
+}
+
+static inline BOOL CLOSE(NSString *tag, NSString *match) {
+	return [tag isEqualToString:match];
+}
+
+/// Previous @c NSScanner implementation. Used as reference in @c benchmarkPlainText
+- (NSString*)htmlToPlainTextLegacy {
 	NSScanner *scanner = [NSScanner scannerWithString:self];
 	scanner.charactersToBeSkipped = NSCharacterSet.newlineCharacterSet; // ! else, some spaces are dropped
 	NSCharacterSet *angleBrackets = [NSCharacterSet characterSetWithCharactersInString:@"<>"];
@@ -51,8 +393,8 @@
 					if (last != '\n') {
 						[result appendString:@"\n"];
 					}
-					if (order > 0) [result appendFormat:@" %d. ", order++];
-					else           [result appendString:@" • "];
+					if (order > 0) [result appendFormat:@" %d. ", order++];
+					else           [result appendString:@" • "];
 				}
 			} else {
 				// append text inbetween tags
@@ -76,21 +418,53 @@
 	 replaceMatchesInString:result options:0 range:NSMakeRange(0, result.length) withTemplate:@"$1"];
 	
 	NSMutableCharacterSet *cs = NSMutableCharacterSet.whitespaceAndNewlineCharacterSet;
-	[cs removeCharactersInString:@" "]; // used for "li"
+	[cs removeCharactersInString:@" "]; // used for "li"
 	return [result stringByTrimmingCharactersInSet:cs];
 }
 
-
-#pragma mark - Helper methods
-
-
-static inline BOOL OPEN(NSString *tag, NSString *match) {
-	return ([tag isEqualToString:match] || [tag hasPrefix:[match stringByAppendingString:@" "]]);
+/// Print result of a single golden-output check.
+static void CheckPlainText(const char *name, NSString *result, NSString *expected) {
+	BOOL ok = [result isEqualToString:expected];
+	printf("%s: %s\n", ok ? "pass" : "FAIL", name);
+	if (!ok) printf("  expected: '%s'\n  received: '%s'\n", expected.UTF8String, result.UTF8String);
 }
 
-static inline BOOL CLOSE(NSString *tag, NSString *match) {
-	return [tag isEqualToString:match];
+/**
+ Developer tool. Compare output against golden corpus (string, data, and previous implementation; invalid UTF-8, embedded NUL, lone surrogate).
+ Then print throughput of @c htmlToPlainText and the previous @c NSScanner implementation. Started with @c barss:config/benchmark/html
+ */
++ (void)benchmarkPlainText {
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+		printf("--- html to plain text: golden output ---\n");
+		for (size_t i = 0; i < sizeof(_golden) / sizeof(_golden[0]); i++) {
+			NSString *html = [NSString stringWithUTF8String:_golden[i].html];
+			NSString *expected = [NSString stringWithUTF8String:_golden[i].text];
+			CheckPlainText(_golden[i].html, [html htmlToPlainText], expected);
+			CheckPlainText("(data)", [NSString plainTextFromHTMLData:[html dataUsingEncoding:NSUTF8StringEncoding]], expected);
+			NSString *legacy = _golden[i].legacy ? [NSString stringWithUTF8String:_golden[i].legacy] : expected;
+			CheckPlainText("(legacy)", [html htmlToPlainTextLegacy], legacy);
+		}
+		CheckPlainText("invalid UTF-8", [NSString plainTextFromHTMLData:[NSData dataWithBytes:"a\xFF\xC0\xAF" "b" length:5]], @" a\uFFFD\uFFFD\uFFFDb");
+		unichar nul[] = {'a', 0, 'b'}, nulExpected[] = {' ', 'a', 0, 'b'};
+		CheckPlainText("embedded NUL", [[NSString stringWithCharacters:nul length:3] htmlToPlainText], [NSString stringWithCharacters:nulExpected length:4]);
+		unichar surrogate[] = {'a', 0xD800, 'b'};
+		NSString *lossy = [[NSString stringWithCharacters:surrogate length:3] htmlToPlainText];
+		printf("%s: lone surrogate -> '%s'\n", ([lossy hasPrefix:@" a"] && [lossy hasSuffix:@"b"]) ? "pass" : "FAIL", lossy.UTF8String);
+		
+		NSMutableString *article = [NSMutableString string];
+		for (int i = 0; i < 1000; i++) {
+			[article appendString:@"<h2>Überschrift &amp; more</h2><p>Lorem ipsum  dolor sit amet, <a href=\"https://example.org\">consectetur</a> "
+			 @"adipiscing elit &hellip;</p>\n<ul><li>one</li><li>two</li></ul><script>var x = 1;</script><br/>\n"];
+		}
+		double mb = [article lengthOfBytesUsingEncoding:NSUTF8StringEncoding] / 1e6;
+		uint64_t fast = dispatch_benchmark(20, ^{ [article htmlToPlainText]; });
+		uint64_t legacy = dispatch_benchmark(20, ^{ [article htmlToPlainTextLegacy]; });
+		printf("--- html to plain text: %.2f MB ---\n", mb);
+		printf("htmlToPlainText: %.1f MB/s\n", mb / (fast / 1e9));
+		printf("NSScanner (previous): %.1f MB/s\n", mb / (legacy / 1e9));
+	});
 }
+#endif
 
 @end
 
@@ -7,6 +7,8 @@ NS_ASSUME_NONNULL_BEGIN
 @interface NSURLRequest (Ext)
 + (instancetype)withURL:(NSString*)urlStr;
 - (NSURLSessionDataTask*)dataTask:(nonnull void(^)(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response))block;
+- (NSURLSessionDataTask*)streamTask:(nonnull BOOL(^)(NSData *received))stop finally:(nonnull void(^)(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response))block;
+- (NSURLSessionDataTask*)streamTask:(nonnull BOOL(^)(NSData *received))stop metrics:(nullable void(^)(NSURLSessionTaskMetrics *metrics))metrics finally:(nonnull void(^)(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response))block;
 - (NSURLSessionDownloadTask*)downloadTask:(void(^)(NSURL * _Nullable path, NSError * _Nullable error))block;
 @end
 
@@ -1,6 +1,7 @@
 #import "NSURLRequest+Ext.h"
 #import "NSString+Ext.h"
 #import "NSError+Ext.h"
+#import "IngestBenchmark.h"
 
 /// @return Shared URL session with caches disabled, enabled gzip encoding and custom user agent.
 static NSURLSession* NonCachingURLSession(void) {
@@ -15,12 +16,112 @@ static NSURLSession* NonCachingURLSession(void) {
 		conf.URLCache = nil; // disables '~/Library/Caches/de.relikd.baRSS/'
 		conf.HTTPAdditionalHeaders = @{ @"User-Agent": @"baRSS (macOS)",
 										@"Accept-Encoding": @"gzip" };
+#ifdef DEBUG
+		// offline fixture server, only used by barss:config/benchmark/ingest
+		conf.protocolClasses = [@[[FixtureURLProtocol class]] arrayByAddingObjectsFromArray:conf.protocolClasses];
+#endif
 		session = [NSURLSession sessionWithConfiguration:conf];
 	});
 	return session;
 }
 
 
+//  ---------------------------------------------------------------
+// |  MARK: - Streaming data task
+//  ---------------------------------------------------------------
+
+/// Internal state of a single @c streamTask:finally: request.
+@interface StreamTaskHandler : NSObject
+@property (nonatomic, strong) NSMutableData *data;
+@property (nonatomic, copy) BOOL(^stop)(NSData *received);
+@property (nonatomic, copy, nullable) void(^metrics)(NSURLSessionTaskMetrics *metrics);
+@property (nonatomic, copy) void(^finally)(NSData * _Nullable data, NSError * _Nullable error, NSURLResponse *response);
+@property (nonatomic, assign) BOOL stopped;
+@end
+
+@implementation StreamTaskHandler
+@end
+
+
+/// Session delegate that collects received data and cancels the task as soon as the @c stop block returns @c YES.
+@interface StreamSessionDelegate : NSObject <NSURLSessionDataDelegate>
+@property (nonatomic, strong) NSMutableDictionary<NSNumber*, StreamTaskHandler*> *handlers;
+@end
+
+@implementation StreamSessionDelegate
+
+- (instancetype)init {
+	self = [super init];
+	_handlers = [NSMutableDictionary dictionary];
+	return self;
+}
+
+- (void)addHandler:(StreamTaskHandler*)handler forTask:(NSURLSessionTask*)task {
+	@synchronized (self) { self.handlers[@(task.taskIdentifier)] = handler; }
+}
+
+- (StreamTaskHandler*)handlerForTask:(NSURLSessionTask*)task remove:(BOOL)flag {
+	@synchronized (self) {
+		StreamTaskHandler *handler = self.handlers[@(task.taskIdentifier)];
+		if (flag) [self.handlers removeObjectForKey:@(task.taskIdentifier)];
+		return handler;
+	}
+}
+
+- (void)URLSession:(NSURLSession *)session dataTask:(NSURLSessionDataTask *)dataTask didReceiveData:(NSData *)data {
+	StreamTaskHandler *handler = [self handlerForTask:dataTask remove:NO];
+	if (!handler || handler.stopped)
+		return;
+	[handler.data appendData:data];
+	if (handler.stop(handler.data)) {
+		handler.stopped = YES;
+		[dataTask cancel];
+	}
+}
+
+/// Called before @c URLSession:task:didCompleteWithError:
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didFinishCollectingMetrics:(NSURLSessionTaskMetrics *)metrics {
+	StreamTaskHandler *handler = [self handlerForTask:task remove:NO];
+	if (handler.metrics)
+		handler.metrics(metrics);
+}
+
+- (void)URLSession:(NSURLSession *)session task:(NSURLSessionTask *)task didCompleteWithError:(nullable NSError *)error {
+	StreamTaskHandler *handler = [self handlerForTask:task remove:YES];
+	if (handler.stopped)
+		error = nil; // canceled by us, not an error
+	handler.finally(handler.data, error, task.response);
+}
+
+@end
+
+
+/// @return Same configuration as @c NonCachingURLSession() but with @c StreamSessionDelegate (data is passed in chunks).
+static NSURLSession* StreamingURLSession(void) {
+	static NSURLSession *session = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		NSURLSessionConfiguration *conf = NonCachingURLSession().configuration;
+		session = [NSURLSession sessionWithConfiguration:conf delegate:[StreamSessionDelegate new] delegateQueue:nil];
+	});
+	return session;
+}
+
+/// Replace @c data with @c nil if status code is @c 304 or an error occurred. Create error for HTTP status codes 4xx and 5xx.
+static void HandleResponseStatus(NSURLRequest *req, NSData * _Nullable __autoreleasing *data, NSError * _Nullable __autoreleasing *error, NSHTTPURLResponse *response) {
+	NSInteger status = [response statusCode];
+#if DEBUG && ENV_LOG_DOWNLOAD
+	/*if (status != 304)*/ printf("GET %ld %s\n", status, req.URL.absoluteString.UTF8String);
+#endif
+	if (*error || status == 304) {
+		*data = nil; // if status == 304, data & error nil
+	} else if (status >= 400 && status < 600) { // catch Client & Server errors
+		*error = [NSError statusCode:status reason:(status >= 500 ? [NSString plainTextFromHTMLData:*data] : nil)];
+		*data = nil;
+	}
+}
+
+
 @implementation NSURLRequest (Ext)
 
 /// @return New request from URL. Ensures that at least @c http scheme is set.
@@ -35,22 +136,39 @@ static NSURLSession* NonCachingURLSession(void) {
 - (NSURLSessionDataTask*)dataTask:(nonnull void(^)(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response))block {
 	NSURLSessionDataTask *task = [NonCachingURLSession() dataTaskWithRequest:self completionHandler:^(NSData * _Nullable data, NSURLResponse * _Nullable response, NSError * _Nullable error) {
 		NSHTTPURLResponse* httpResponse = (NSHTTPURLResponse*)response;
-		NSInteger status = [httpResponse statusCode];
-#if DEBUG && ENV_LOG_DOWNLOAD
-		/*if (status != 304)*/ printf("GET %ld %s\n", status, self.URL.absoluteString.UTF8String);
-#endif
-		if (error || status == 304) {
-			data = nil; // if status == 304, data & error nil
-		} else if (status >= 400 && status < 600) { // catch Client & Server errors
-			error = [NSError statusCode:status reason:(status >= 500 ? [NSString plainTextFromHTMLData:data] : nil)];
-			data = nil;
-		}
+		HandleResponseStatus(self, &data, &error, httpResponse);
 		block(data, error, httpResponse);
 	}];
 	[task resume];
 	return task;
 }
 
+/**
+ Same as @c dataTask: but data is collected in chunks. After each chunk @c stop is called with all data received so far.
+ If @c stop returns @c YES the transfer is canceled and @c block is called with the partial data (and no error).
+ */
+- (NSURLSessionDataTask*)streamTask:(nonnull BOOL(^)(NSData *received))stop finally:(nonnull void(^)(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response))block {
+	return [self streamTask:stop metrics:nil finally:block];
+}
+
+/// Same as @c streamTask:finally: but additionally reports @c NSURLSessionTaskMetrics (called before @c block ).
+- (NSURLSessionDataTask*)streamTask:(nonnull BOOL(^)(NSData *received))stop metrics:(nullable void(^)(NSURLSessionTaskMetrics *metrics))metrics finally:(nonnull void(^)(NSData * _Nullable data, NSError * _Nullable error, NSHTTPURLResponse *response))block {
+	NSURLSession *session = StreamingURLSession();
+	NSURLSessionDataTask *task = [session dataTaskWithRequest:self];
+	StreamTaskHandler *handler = [StreamTaskHandler new];
+	handler.data = [NSMutableData data];
+	handler.stop = stop;
+	handler.metrics = metrics;
+	handler.finally = ^(NSData * _Nullable data, NSError * _Nullable error, NSURLResponse *response) {
+		NSHTTPURLResponse* httpResponse = (NSHTTPURLResponse*)response;
+		HandleResponseStatus(self, &data, &error, httpResponse);
+		block(data, error, httpResponse);
+	};
+	[(StreamSessionDelegate*)session.delegate addHandler:handler forTask:task];
+	[task resume];
+	return task;
+}
+
 /// Prepare a download task and immediatelly perform request with non caching URL session.
 - (NSURLSessionDownloadTask*)downloadTask:(void(^)(NSURL * _Nullable path, NSError * _Nullable error))block {
 	NSURLSessionDownloadTask *task = [NonCachingURLSession() downloadTaskWithRequest:self completionHandler:^(NSURL * _Nullable location, NSURLResponse * _Nullable response, NSError * _Nullable error) {
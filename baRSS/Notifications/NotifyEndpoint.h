@@ -14,6 +14,8 @@ API_AVAILABLE(macos(10.14))
 + (void)postArticle:(FeedArticle*)article;
 
 + (void)dismiss:(nullable NSArray<NSString*>*)list;
++ (void)beginBatch;
++ (void)endBatch;
 @end
 
 NS_ASSUME_NONNULL_END
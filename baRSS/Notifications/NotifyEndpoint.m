@@ -15,12 +15,51 @@ static NSString* const kActionOpenBackground = @"OPEN_IN_BACKGROUND";
 static NSString* const kActionMarkRead = @"MARK_READ_DONT_OPEN";
 static NSString* const kActionOpenOnly = @"OPEN_ONLY_DONT_MARK_READ";
 
+/// Pending posts and dismissals are collected for this long before they are delivered.
+static NSTimeInterval const kNotifyCoalesceDelay = 0.5;
+/// Minimum time between two deliveries of new notifications (rate limit). Dismissals are not limited.
+static NSTimeInterval const kNotifyMinInterval = 5.0;
+/// Max. number of article notifications per feed and delivery. More articles are collapsed into a per-feed summary.
+static NSUInteger const kNotifyMaxPerFeed = 3;
+/// Max. number of notifications per delivery. More are collapsed into a single global summary.
+static NSUInteger const kNotifyMaxPerDelivery = 8;
+
+
+#pragma mark - Pending notification
+
+/// Queued notification, not yet delivered. Plain strings only, can be passed between threads.
+@interface PendingNotification : NSObject
+@property (nonatomic, copy) NSString *identifier;
+@property (nonatomic, copy) NSString *thread; // feed notification ID (same as identifier for feed and global notifications)
+@property (nonatomic, copy, nullable) NSString *title;
+@property (nonatomic, copy, nullable) NSString *body;
+@property (nonatomic, assign) NSUInteger count; // number of unread articles represented by this notification
+@end
+
+@implementation PendingNotification
+@end
+
 
 @implementation NotifyEndpoint
 
 API_AVAILABLE(macos(10.14))
 static NotifyEndpoint *singleton = nil;
 static NotificationType notifyType;
+// Delivery queue (main thread only)
+static NSMutableDictionary<NSString*, PendingNotification*> *_pendingPosts;
+static NSMutableOrderedSet<NSString*> *_pendingOrder; // post order of @c _pendingPosts
+static NSMutableSet<NSString*> *_pendingDismiss;
+static NSUInteger _batchDepth = 0;
+static BOOL _deliveryScheduled = NO;
+static CFAbsoluteTime _lastDelivery = 0;
+
++ (void)initialize {
+	if (self == [NotifyEndpoint class]) {
+		_pendingPosts = [NSMutableDictionary dictionary];
+		_pendingOrder = [NSMutableOrderedSet orderedSet];
+		_pendingDismiss = [NSMutableSet set];
+	}
+}
 
 /// Ask user for permission to send notifications @b AND register delegate to respond to alert banner clicks.
 /// @note Called every time user changes notification settings
@@ -68,7 +107,7 @@ static NotificationType notifyType;
 		// ignore and keep old count until 0?
 		// or update count and show a new notification banner?
 		if (newCount > oldCount) { // only notify if new feeds (quirk: will also trigger for option-click menu to mark unread)
-			[self send:kNotifyIdGlobal
+			[self post:kNotifyIdGlobal thread:kNotifyIdGlobal count:(NSUInteger)newCount
 				 title:APP_NAME
 				  body:[NSString stringWithFormat:NSLocalizedString(@"%ld unread articles", nil), newCount]];
 		}
@@ -85,7 +124,7 @@ static NotificationType notifyType;
 	NSUInteger count = feed.countUnread;
 	if (count > 0) {
 		[feed.managedObjectContext obtainPermanentIDsForObjects:@[feed] error:nil];
-		[self send:feed.notificationID
+		[self post:feed.notificationID thread:feed.notificationID count:count
 			 title:feed.group.anyName
 			  body:[NSString stringWithFormat:NSLocalizedString(@"%ld unread articles", nil), count]];
 	}
@@ -96,53 +135,168 @@ static NotificationType notifyType;
 	if (notifyType != NotificationTypePerArticle) {
 		return;
 	}
-	[article.managedObjectContext obtainPermanentIDsForObjects:@[article] error:nil];
-	[self send:article.notificationID
+	[article.managedObjectContext obtainPermanentIDsForObjects:@[article, article.feed] error:nil];
+	[self post:article.notificationID thread:article.feed.notificationID count:1
 		 title:article.feed.group.anyName
 		  body:article.title];
 }
 
-/// Close already posted notifications because they were opened via menu
+/// Close already posted notifications because they were opened via menu. Removes pending notifications with the same ID.
 + (void)dismiss:(nullable NSArray<NSString*>*)list {
-	if (list.count > 0) {
-		[UNUserNotificationCenter.currentNotificationCenter removeDeliveredNotificationsWithIdentifiers:list];
-	}
+	if (list.count == 0)
+		return;
+	NSArray<NSString*> *ids = [list copy];
+	dispatch_async(dispatch_get_main_queue(), ^{
+		for (NSString *identifier in ids) {
+			if (_pendingPosts[identifier]) {
+				[_pendingPosts removeObjectForKey:identifier];
+				[_pendingOrder removeObject:identifier];
+			}
+			[_pendingDismiss addObject:identifier];
+		}
+		[self scheduleDelivery:kNotifyCoalesceDelay];
+	});
+}
+
+/// Hold back new notifications until the matching @c endBatch (e.g., during an update cycle). Dismissals are not affected.
+/// @note Must be called on main thread. Calls can be nested.
++ (void)beginBatch {
+	_batchDepth += 1;
+}
+
+/// Deliver all notifications collected since @c beginBatch (subject to rate limit).
++ (void)endBatch {
+	if (_batchDepth > 0 && --_batchDepth == 0)
+		[self scheduleDelivery:kNotifyCoalesceDelay];
 }
 
 
-#pragma mark - Helper methods
+#pragma mark - Delivery queue
 
-/// Post notification (immediatelly).
+/// Queue notification for delivery. Replaces a pending notification with the same identifier. Can be called from any thread.
 /// @param identifier Used to identify a specific instance (and dismiss a previously shown notification).
-+ (void)send:(NSString *)identifier title:(nullable NSString *)title body:(nullable NSString *)body {
-	UNMutableNotificationContent *msg = [UNMutableNotificationContent new];
-	if (title != nil) msg.title = title;
-	if (body != nil) msg.body = body;
-	// common settings:
-	msg.categoryIdentifier = kCategoryDismissable;
-	// TODO: make sound configurable?
-	msg.sound = [UNNotificationSound defaultSound];
-	[self send:identifier content: msg];
+/// @param thread Notifications with the same thread are grouped and collapsed into a single summary if needed.
++ (void)post:(NSString*)identifier thread:(NSString*)thread count:(NSUInteger)count title:(nullable NSString*)title body:(nullable NSString*)body {
+	PendingNotification *pn = [PendingNotification new];
+	pn.identifier = identifier;
+	pn.thread = thread;
+	pn.count = count;
+	pn.title = title;
+	pn.body = body;
+	dispatch_async(dispatch_get_main_queue(), ^{
+		_pendingPosts[identifier] = pn;
+		[_pendingOrder addObject:identifier]; // no-op if already queued, keeps first position
+		[_pendingDismiss removeObject:identifier];
+		[self scheduleDelivery:kNotifyCoalesceDelay];
+	});
 }
 
-/// Internal method for queueing a new notification.
-+ (void)send:(NSString *)identifier content:(UNMutableNotificationContent*)msg {
+/// Start delivery timer if not running already. Subsequent posts and dismissals are delivered together.
++ (void)scheduleDelivery:(NSTimeInterval)delay {
+	if (_deliveryScheduled)
+		return;
+	if (_pendingDismiss.count == 0 && (_pendingOrder.count == 0 || _batchDepth > 0))
+		return;
+	_deliveryScheduled = YES;
+	[self performSelector:@selector(deliver) withObject:nil afterDelay:delay];
+}
+
+/// Remove all pending dismissals with a single call. Post pending notifications, unless rate limited or batch is open.
++ (void)deliver {
+	_deliveryScheduled = NO;
 	UNUserNotificationCenter *center = UNUserNotificationCenter.currentNotificationCenter;
+	if (_pendingDismiss.count > 0) {
+		[center removeDeliveredNotificationsWithIdentifiers:_pendingDismiss.allObjects];
+		[_pendingDismiss removeAllObjects];
+	}
+	if (_pendingOrder.count == 0 || _batchDepth > 0)
+		return;
+	NSTimeInterval wait = _lastDelivery + kNotifyMinInterval - CFAbsoluteTimeGetCurrent();
+	if (wait > 0) {
+		[self scheduleDelivery:wait];
+		return;
+	}
+	_lastDelivery = CFAbsoluteTimeGetCurrent();
+	NSArray<PendingNotification*> *list = [self collapsePending];
+#ifdef DEBUG
+	NSLog(@"notifications: %lu queued, %lu delivered", _pendingOrder.count, list.count);
+#endif
+	[_pendingPosts removeAllObjects];
+	[_pendingOrder removeAllObjects];
 	
 	[center getNotificationSettingsWithCompletionHandler:^(UNNotificationSettings * _Nonnull settings) {
 		if (settings.authorizationStatus != UNAuthorizationStatusAuthorized) {
 			return;
 		}
-		
-		UNNotificationRequest *req = [UNNotificationRequest requestWithIdentifier:identifier content:msg trigger:nil];
-		[center addNotificationRequest:req withCompletionHandler:^(NSError * _Nullable error) {
-			if (error) {
-				NSLog(@"Could not send notification: %@", error);
-			}
-		}];
+		BOOL first = YES;
+		for (PendingNotification *pn in list) {
+			UNMutableNotificationContent *msg = [UNMutableNotificationContent new];
+			if (pn.title != nil) msg.title = pn.title;
+			if (pn.body != nil) msg.body = pn.body;
+			msg.threadIdentifier = pn.thread;
+			msg.categoryIdentifier = kCategoryDismissable;
+			// TODO: make sound configurable?
+			if (first) msg.sound = [UNNotificationSound defaultSound]; // one sound per delivery
+			first = NO;
+			UNNotificationRequest *req = [UNNotificationRequest requestWithIdentifier:pn.identifier content:msg trigger:nil];
+			[center addNotificationRequest:req withCompletionHandler:^(NSError * _Nullable error) {
+				if (error) {
+					NSLog(@"Could not send notification: %@", error);
+				}
+			}];
+		}
 	}];
 }
 
+/**
+ Merge pending notifications of the same thread (feed).
+ Feeds with more than @c kNotifyMaxPerFeed articles are replaced by a per-feed summary.
+ If the result exceeds @c kNotifyMaxPerDelivery notifications, all are replaced by a single global summary.
+ */
++ (NSArray<PendingNotification*>*)collapsePending {
+	NSMutableDictionary<NSString*, NSMutableArray<PendingNotification*>*> *byThread = [NSMutableDictionary dictionary];
+	NSMutableArray<NSString*> *threads = [NSMutableArray array];
+	for (NSString *identifier in _pendingOrder) {
+		PendingNotification *pn = _pendingPosts[identifier];
+		if (!byThread[pn.thread]) {
+			byThread[pn.thread] = [NSMutableArray array];
+			[threads addObject:pn.thread];
+		}
+		[byThread[pn.thread] addObject:pn];
+	}
+	NSMutableArray<PendingNotification*> *rv = [NSMutableArray arrayWithCapacity:_pendingOrder.count];
+	NSUInteger total = 0, feeds = 0;
+	for (NSString *thread in threads) {
+		NSArray<PendingNotification*> *list = byThread[thread];
+		NSUInteger count = [[list valueForKeyPath:@"@sum.count"] unsignedIntegerValue];
+		if (![thread isEqualToString:kNotifyIdGlobal]) {
+			total += count;
+			feeds += 1;
+		}
+		if (list.count > kNotifyMaxPerFeed) {
+			PendingNotification *summary = [PendingNotification new];
+			summary.identifier = thread; // same as feed notification, opens all unread articles of feed
+			summary.thread = thread;
+			summary.count = count;
+			summary.title = list.firstObject.title;
+			summary.body = [NSString stringWithFormat:NSLocalizedString(@"%ld unread articles", nil), count];
+			[rv addObject:summary];
+		} else {
+			[rv addObjectsFromArray:list];
+		}
+	}
+	if (rv.count > kNotifyMaxPerDelivery) {
+		PendingNotification *summary = [PendingNotification new];
+		summary.identifier = kNotifyIdGlobal; // opens all unread articles
+		summary.thread = kNotifyIdGlobal;
+		summary.count = total;
+		summary.title = APP_NAME;
+		summary.body = [NSString stringWithFormat:NSLocalizedString(@"%ld unread articles in %ld feeds", nil), total, feeds];
+		return @[summary];
+	}
+	return rv;
+}
+
 
 #pragma mark - Delegate
 
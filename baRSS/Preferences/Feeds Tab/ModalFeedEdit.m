@@ -2,7 +2,9 @@
 #import "ModalFeedEdit.h"
 #import "ModalFeedEditView.h"
 #import "RefreshStatisticsView.h"
+#import "UpdateMetrics.h"
 #import "Constants.h"
+#import "UserPrefs.h"
 #import "FeedDownload.h"
 #import "FaviconDownload.h"
 #import "Feed+Ext.h"
@@ -76,6 +78,11 @@
 	self.previousURL = @"";
 	self.view.refreshNum.intValue = 30;
 	[NSDate populateUnitsMenu:self.view.refreshUnit selected:TimeUnitMinutes];
+	[self.view.refreshUnit.menu addItem:[NSMenuItem separatorItem]];
+	[self.view.refreshUnit addItemWithTitle:NSLocalizedString(@"Automatic", nil)];
+	self.view.refreshUnit.lastItem.tag = kFeedRefreshAuto;
+	[self setRetentionPlaceholder:self.view.retainCount pref:Pref_retainArticleCount];
+	[self setRetentionPlaceholder:self.view.retainDays pref:Pref_retainArticleDays];
 	[self populateTextFields:self.feedGroup];
 	
 	// removed in windowShouldClose:
@@ -96,9 +103,28 @@
 	self.view.favicon.image = [fg.feed iconImage16];
 	self.view.regexConverterButton.hidden = !fg.feed.regex;
 	[NSDate setInterval:fg.feed.meta.refresh forPopup:self.view.refreshUnit andField:self.view.refreshNum animate:NO];
+	[self populateRetention:fg.feed.meta];
 	[self statsForCoreDataObject];
 }
 
+/// Show per feed retention values. Empty fields and mixed checkbox state will use global settings.
+- (void)populateRetention:(FeedMeta*)meta {
+	self.view.retainCount.stringValue = (meta.retainCount > 0 ? [NSString stringWithFormat:@"%d", meta.retainCount] : @"");
+	self.view.retainDays.stringValue = (meta.retainDays > 0 ? [NSString stringWithFormat:@"%d", meta.retainDays] : @"");
+	switch (meta.retainUnread) {
+		case kFeedRetainDefault: self.view.retainUnread.state = NSControlStateValueMixed; break;
+		case 0: self.view.retainUnread.state = NSControlStateValueOff; break;
+		default: self.view.retainUnread.state = NSControlStateValueOn; break;
+	}
+}
+
+/// Show global retention setting as placeholder (if set). Otherwise, keep "∞".
+- (void)setRetentionPlaceholder:(NSTextField*)field pref:(NSString*)key {
+	NSUInteger val = UserPrefsUInt(key);
+	if (val > 0)
+		field.placeholderString = [field.formatter stringForObjectValue:@(val)];
+}
+
 - (void)dealloc {
 	[self.faviconFile remove]; // Delete temporary favicon (if still exists)
 }
@@ -114,14 +140,17 @@
 	Interval intv = [NSDate intervalForPopup:self.view.refreshUnit andField:self.view.refreshNum];
 	[self.feedGroup setNameIfChanged:self.view.name.stringValue];
 	[f.meta setRefreshIfChanged:intv];
+	NSControlStateValue keepUnread = self.view.retainUnread.state;
+	[f.meta setRetainCount:self.view.retainCount.intValue days:self.view.retainDays.intValue
+					unread:(keepUnread == NSControlStateValueMixed ? kFeedRetainDefault : keepUnread == NSControlStateValueOn)];
 	if (self.memFeed) { // newly created
 		[self.memFeed copyValuesTo:f ignoreError:YES];
 		if (self.faviconFile) // only if downloaded anything (nil deletes icon!)
 			[f setNewIcon:self.faviconFile];
 		self.faviconFile = nil;
 	} else { // updating existing feed meta
-		if (f.meta.scheduled == nil || f.meta.scheduled.timeIntervalSinceNow > f.meta.refresh) {
-			[f.meta scheduleNow:f.meta.refresh];
+		if (f.meta.scheduled == nil || f.meta.scheduled.timeIntervalSinceNow > [f.meta effectiveRefresh]) {
+			[f.meta scheduleNow:[f.meta effectiveRefresh]];
 		}
 	}
 }
@@ -304,7 +333,8 @@
 	}
 	
 	NSDictionary *stats = [NSDate refreshIntervalStatistics:dates];
-	RefreshStatisticsView *rsv = [[RefreshStatisticsView alloc] initWithRefreshInterval:stats articleCount:count callback:self];
+	NSDictionary *metrics = [UpdateMetrics summaryForFeed:self.feedGroup.feed.meta.url ?: @""];
+	RefreshStatisticsView *rsv = [[RefreshStatisticsView alloc] initWithRefreshInterval:stats articleCount:count metrics:metrics callback:self];
 	[[self getModalSheet] extendContentViewBy:NSHeight(rsv.frame) + PAD_L - prevHeight];
 	self.statisticsView = [rsv placeIn:self.view x:CENTER y:0];
 }
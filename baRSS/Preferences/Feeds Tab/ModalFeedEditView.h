@@ -14,6 +14,10 @@ NS_ASSUME_NONNULL_BEGIN
 @property (strong) IBOutlet NSTextField *refreshNum;
 @property (strong) IBOutlet NSPopUpButton *refreshUnit;
 
+@property (strong) IBOutlet NSTextField *retainCount;
+@property (strong) IBOutlet NSTextField *retainDays;
+@property (strong) IBOutlet NSButton *retainUnread;
+
 @property (strong) IBOutlet NSButton *warningButton;
 @property NSPopover *warningPopover;
 @property (strong) IBOutlet NSTextField *warningText;
@@ -9,7 +9,8 @@
 - (instancetype)initWithController:(ModalFeedEdit*)controller {
 	NSArray *lbls = @[NSLocalizedString(@"URL", nil),
 					  NSLocalizedString(@"Name", nil),
-					  NSLocalizedString(@"Refresh", nil)];
+					  NSLocalizedString(@"Refresh", nil),
+					  NSLocalizedString(@"Keep", nil)];
 	NSView *labels = [NSView labelColumn:lbls rowHeight:HEIGHT_INPUTFIELD padding:PAD_S];
 	
 	
@@ -38,12 +39,25 @@
 								   action:@selector(openRegexConverter) target:controller]
 								  tooltip:NSLocalizedString(@"Regex converter", nil)]
 								 placeIn:self xRight:0 yTop:2*rowHeight + 1];
+	// 4. row
+	self.retainCount = [[[NSView integerField:@"∞" unit:NSLocalizedString(@"%ld articles", nil) width:85]
+						 tooltip:NSLocalizedString(@"Max. number of stored articles. Older articles are deleted.", nil)]
+						placeIn:self x:x yTop:3*rowHeight];
+	self.retainDays = [[[NSView integerField:@"∞" unit:NSLocalizedString(@"%ld days", nil) width:85]
+						tooltip:NSLocalizedString(@"Max. age of stored articles. Older articles are deleted.", nil)]
+					   placeIn:self x:NSMaxX(self.retainCount.frame) + PAD_M yTop:3*rowHeight];
+	self.retainUnread = [[[NSView checkbox:NO]
+						  tooltip:NSLocalizedString(@"Keep unread articles (mixed state: use global setting)", nil)]
+						 placeIn:self x:NSMaxX(self.retainDays.frame) + PAD_M yTop:3*rowHeight + (HEIGHT_INPUTFIELD - HEIGHT_CHECKBOX) / 2];
 	
 	// initial state
 	self.url.accessibilityLabel = lbls[0];
 	self.name.accessibilityLabel = lbls[1];
 	self.favicon.accessibilityLabel = nil; // disable `accessibilityDescription` of `RSSImageDefaultRSSIcon`
 	self.refreshNum.accessibilityLabel = NSLocalizedString(@"Refresh interval", nil);
+	self.retainUnread.accessibilityLabel = NSLocalizedString(@"Keep unread articles", nil);
+	self.retainUnread.allowsMixedState = YES;
+	self.retainUnread.state = NSControlStateValueMixed;
 	self.url.delegate = controller;
 	self.warningButton.hidden = YES;
 	self.regexConverterButton.hidden = YES;
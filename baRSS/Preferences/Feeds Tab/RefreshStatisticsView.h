@@ -10,7 +10,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 
 @interface RefreshStatisticsView : NSView
-- (instancetype)initWithRefreshInterval:(NSDictionary*)info articleCount:(NSUInteger)count callback:(nullable id<RefreshIntervalButtonDelegate>)callback NS_DESIGNATED_INITIALIZER;
+- (instancetype)initWithRefreshInterval:(NSDictionary*)info articleCount:(NSUInteger)count metrics:(nullable NSDictionary*)metrics callback:(nullable id<RefreshIntervalButtonDelegate>)callback NS_DESIGNATED_INITIALIZER;
 - (instancetype)initWithFrame:(NSRect)frameRect NS_UNAVAILABLE;
 - (nullable instancetype)initWithCoder:(NSCoder *)decoder NS_UNAVAILABLE;
 @end
@@ -9,34 +9,62 @@
  
  @param info The dictionary generated with @c -refreshInterval:
  @param count Article count.
+ @param metrics Update timing generated with @c UpdateMetrics @c summaryForFeed: (optional).
  @param callback If set, @c sender will be called with @c -refreshIntervalButtonClicked:.
                  If not disable button border and display as bold inline text.
  @return Centered view without autoresizing.
  */
-- (instancetype)initWithRefreshInterval:(NSDictionary*)info articleCount:(NSUInteger)count callback:(nullable id<RefreshIntervalButtonDelegate>)callback {
+- (instancetype)initWithRefreshInterval:(NSDictionary*)info articleCount:(NSUInteger)count metrics:(nullable NSDictionary*)metrics callback:(nullable id<RefreshIntervalButtonDelegate>)callback {
 	self = [super initWithFrame:NSMakeRect(0, 0, 320, 327)];
 	self.autoresizesSubviews = NO;
 	
-	NSTextField *dateView = [self viewForArticlesCount:count latest:info];
-	if (!info || info.count == 0) {
-		[self setFrameSize:dateView.frame.size];
-		[dateView placeIn:self x:0 y:0];
-	} else {
+	NSMutableArray<NSView*> *rows = [NSMutableArray arrayWithObject:[self viewForArticlesCount:count latest:info]];
+	if (info.count > 0) {
 		NSArray *arr = @[GrayLabel(NSLocalizedString(@"min:", nil)), [self createInlineButton:info[@"min"] callback:callback],
 						 GrayLabel(NSLocalizedString(@"max:", nil)), [self createInlineButton:info[@"max"] callback:callback],
 						 GrayLabel(NSLocalizedString(@"avg:", nil)), [self createInlineButton:info[@"avg"] callback:callback],
 						 GrayLabel(NSLocalizedString(@"median:", nil)), [self createInlineButton:info[@"median"] callback:callback]];
-		NSView *buttonsView = [self placeViewsHorizontally:arr];
-		
-		CGFloat w = NSMaxWidth(dateView, buttonsView);
-		[self setFrameSize:NSMakeSize(w, NSHeight(buttonsView.frame) + PAD_M + NSHeight(dateView.frame))];
-		
-		[dateView placeIn:self x:CENTER yTop:0];
-		[buttonsView placeIn:self x:CENTER y:0];
+		[rows addObject:[self placeViewsHorizontally:arr]];
+	}
+	if (metrics.count > 0) {
+		[rows addObjectsFromArray:[self viewsForUpdateMetrics:metrics]];
+	}
+	// stack rows vertically
+	CGFloat w = 0, h = -PAD_M;
+	for (NSView *v in rows) {
+		w = MAX(w, NSWidth(v.frame));
+		h += NSHeight(v.frame) + PAD_M;
+	}
+	[self setFrameSize:NSMakeSize(w, h)];
+	CGFloat y = 0;
+	for (NSView *v in rows) {
+		[v placeIn:self x:CENTER yTop:y];
+		y += NSHeight(v.frame) + PAD_M;
 	}
 	return self;
 }
 
+/// Two labels: average and max. update duration; stages of last update (network timeline, parse, save).
+- (NSArray<NSTextField*>*)viewsForUpdateMetrics:(NSDictionary*)metrics {
+	NSString *summary = [NSString stringWithFormat:NSLocalizedString(@"Update: %@ avg, %@ max (%@ updates)", nil),
+						 MillisString(metrics[@"avg"]), MillisString(metrics[@"max"]), metrics[@"count"]];
+	NSDictionary *last = metrics[@"last"];
+	NSMutableArray<NSString*> *stages = [NSMutableArray arrayWithCapacity:7];
+	for (NSString *key in @[@"dns", @"connect", @"tls", @"ttfb", @"transfer", @"parse", @"save"]) {
+		if (last[key])
+			[stages addObject:[NSString stringWithFormat:@"%@ %@", key.uppercaseString, MillisString(last[key])]];
+	}
+	NSString *detail = [NSString stringWithFormat:NSLocalizedString(@"Last: %@", nil), [stages componentsJoinedByString:@", "]];
+	return @[GrayLabel(summary), GrayLabel(detail)];
+}
+
+/// @return Milliseconds below 1s, otherwise seconds with one decimal place.
+static NSString* MillisString(NSNumber *ms) {
+	if (ms.longValue < 1000)
+		return [NSString stringWithFormat:@"%ld ms", ms.longValue];
+	return [NSString stringWithFormat:@"%.1f s", ms.doubleValue / 1000];
+}
+
 /// TextField with article count and latest article date.
 - (NSTextField*)viewForArticlesCount:(NSUInteger)count latest:(nullable NSDictionary*)info {
 	NSString *text = [NSString stringWithFormat:NSLocalizedString(@"%lu articles.", nil), count];
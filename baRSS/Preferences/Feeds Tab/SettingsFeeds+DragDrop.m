@@ -39,7 +39,8 @@ const NSPasteboardType dragReorder = @"de.relikd.baRSS.drag-reorder";
 /// Prohibit drag if destination is leaf or source has no opml
 - (NSDragOperation)outlineView:(NSOutlineView *)outlineView validateDrop:(id <NSDraggingInfo>)info proposedItem:(NSTreeNode*)parent proposedChildIndex:(NSInteger)index {
 	if (info.numberOfValidItemsForDrop == 0 // none of the files is opml
-		|| (index == -1 && [parent isLeaf])) { // drag on specific item (-1) that is not a group
+		|| (index == -1 && [parent isLeaf]) // drag on specific item (-1) that is not a group
+		|| self.importInProgress) {
 		return NSDragOperationNone;
 	}
 	if (info.draggingSource == outlineView) {
@@ -70,10 +71,15 @@ const NSPasteboardType dragReorder = @"de.relikd.baRSS.drag-reorder";
 		
 		// Internal item reordering (dragReorder)
 		[self beginCoreDataChange];
+		NSArray<FeedGroup*> *moved = [self.currentlyDraggedNodes valueForKeyPath:@"representedObject"];
+		NSArray<NSString*> *previousPaths = [moved valueForKeyPath:@"indexPathString"];
 		NSArray<NSTreeNode*> *previousParents = [self.currentlyDraggedNodes valueForKeyPath:@"parentNode"];
 		[self.dataStore moveNodes:self.currentlyDraggedNodes toIndexPath:[newParent.indexPath indexPathByAddingIndex:idx]];
 		[self restoreOrderingAndIndexPathStr:[previousParents arrayByAddingObject:newParent]];
-		[self endCoreDataChangeUndoEmpty:YES forceUndo:NO];
+		if ([self endCoreDataChangeUndoEmpty:YES forceUndo:NO]) {
+			NSArray<NSString*> *paths = [moved valueForKeyPath:@"indexPathString"];
+			PostNotification(kNotificationFeedTreeChanged, [NSDictionary dictionaryWithObjects:paths forKeys:previousPaths]);
+		}
 	} else {
 		// File import
 		NSArray<NSURL*> *files = [info.draggingPasteboard readObjectsForClasses:@[NSURL.class] options:@{ NSPasteboardURLReadingContentsConformToTypesKey: @[UTI_OPML] }];
@@ -110,15 +116,22 @@ const NSPasteboardType dragReorder = @"de.relikd.baRSS.drag-reorder";
 	return self.dataStore.managedObjectContext;
 }
 
-/// OPML import (will begin)
+/// OPML import (will begin). Editing is disabled until all imported feeds are downloaded.
 - (void)opmlFileImportWillBegin:(NSManagedObjectContext*)moc {
+	self.importInProgress = YES;
 	[self beginCoreDataChange];
 }
 
-/// OPML import (did end). Save changes, select newly inserted, and perform web request.
+/// OPML import (progress). Show number of inserted items in status bar.
+- (void)opmlFileImport:(NSManagedObjectContext*)moc progress:(NSUInteger)done total:(NSUInteger)total duplicates:(NSUInteger)skipped {
+	[self showImportProgress:done total:total duplicates:skipped];
+}
+
+/// OPML import (did end). Save changes, select newly inserted, and perform web request (in stages, if many).
 - (void)opmlFileImportDidEnd:(NSManagedObjectContext*)moc {
 	if (moc.undoManager.groupingLevel == 1 && !moc.hasChanges) { // exit early, dont need to create empty arrays
 		[self endCoreDataChangeUndoEmpty:YES forceUndo:YES];
+		self.importInProgress = NO;
 		return;
 	}
 	// Get list of feeds, and root level selection
@@ -135,11 +148,13 @@ const NSPasteboardType dragReorder = @"de.relikd.baRSS.drag-reorder";
 	}
 	// Persist state, because on crash we have at least inserted items (without articles & icons)
 	[StoreCoordinator saveContext:moc andParent:YES];
+	PostNotification(kNotificationFeedTreeChanged, nil);
 	if (selection.count > 0)
 		[self.dataStore setSelectionIndexPaths:[selection sortedArrayUsingSelector:@selector(compare:)]];
 	
-	[UpdateScheduler downloadList:feedsList userInitiated:YES notifications:NO finally:^{
+	[UpdateScheduler downloadStagedList:feedsList finally:^{
 		[self endCoreDataChangeUndoEmpty:NO forceUndo:NO];
+		self.importInProgress = NO;
 		for (Feed *f in feedsList)
 			[moc refreshObject:f.group mergeChanges:NO]; // fixes blank icon if imported with no inet conn
 		[UpdateScheduler scheduleNextFeed];
@@ -6,6 +6,8 @@ NS_ASSUME_NONNULL_BEGIN
 @interface SettingsFeeds : NSViewController <NSOutlineViewDelegate>
 @property (strong) NSTreeController *dataStore;
 @property (strong, nullable) NSArray<NSTreeNode*> *currentlyDraggedNodes;
+/// @c YES from begin of OPML import until all imported feeds are downloaded. Disables all editing.
+@property (nonatomic, assign) BOOL importInProgress;
 
 - (void)editSelectedItem;
 - (void)doubleClickOutlineView:(NSOutlineView*)sender;
@@ -18,6 +20,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (void)beginCoreDataChange;
 - (BOOL)endCoreDataChangeUndoEmpty:(BOOL)undoEmpty forceUndo:(BOOL)force;
+- (void)showImportProgress:(NSUInteger)done total:(NSUInteger)total duplicates:(NSUInteger)skipped;
 - (void)restoreOrderingAndIndexPathStr:(NSArray<NSTreeNode*>*)parentsList;
 @end
 
@@ -70,6 +70,7 @@
 	self.dataStore = [[NSTreeController alloc] init];
 	self.dataStore.managedObjectContext = [StoreCoordinator createChildContext];
 	self.dataStore.managedObjectContext.undoManager = self.undoManager;
+	[StoreCoordinator registerContextForBatchChanges:self.dataStore.managedObjectContext];
 	self.dataStore.childrenKeyPath = @"children";
 	self.dataStore.leafKeyPath = @"type";
 	self.dataStore.entityName = @"FeedGroup";
@@ -147,6 +148,16 @@
 #pragma mark - Activity Spinner & Status Info
 
 
+/**
+ Disable outline view, toolbar buttons, and edit commands during OPML import.
+ Otherwise, user changes would end up in the (still open) undo group of the import.
+ */
+- (void)setImportInProgress:(BOOL)flag {
+	_importInProgress = flag;
+	self.dataStore.editable = !flag; // add & remove buttons are bound to canInsert & canRemove
+	self.view.outline.enabled = !flag;
+}
+
 /// Callback method to update status info. Called more often as the interval is getting shorter.
 - (void)updateStatusInfo {
 	if ([UpdateScheduler feedsInQueue] > 0) {
@@ -165,6 +176,20 @@
 	}
 }
 
+/// Show OPML import progress in status info. Last message stays visible for a few seconds (or until download starts).
+- (void)showImportProgress:(NSUInteger)done total:(NSUInteger)total duplicates:(NSUInteger)skipped {
+	BOOL finished = (done >= total);
+	[self.timerStatusInfo setFireDate:(finished ? [NSDate dateWithTimeIntervalSinceNow:3] : [NSDate distantFuture])];
+	NSString *str = [NSString stringWithFormat:NSLocalizedString(@"Importing %lu of %lu items …", nil), done, total];
+	if (skipped > 0)
+		str = [str stringByAppendingFormat:NSLocalizedString(@" (%lu duplicates skipped)", nil), skipped];
+	self.view.status.stringValue = str;
+	if (finished)
+		[self.view.spinner stopAnimation:nil];
+	else
+		[self.view.spinner startAnimation:nil];
+}
+
 
 #pragma mark - UI Button Interaction
 
@@ -202,12 +227,16 @@
 - (void)remove:(id)sender {
 	NSArray<NSTreeNode*> *nodes = [self userSelectionAll];
 	NSArray<NSTreeNode*> *parentNodes = [nodes valueForKeyPath:@"parentNode"];
+	NSArray<NSString*> *paths = [nodes valueForKeyPath:@"representedObject.indexPathString"];
 	[self beginCoreDataChange];
 	[self.dataStore removeObjectsAtArrangedObjectIndexPaths:[nodes valueForKeyPath:@"indexPath"]];
 	[self restoreOrderingAndIndexPathStr:parentNodes];
 	[self endCoreDataChangeUndoEmpty:NO forceUndo:NO];
 	[UpdateScheduler scheduleNextFeed];
-	PostNotification(kNotificationTotalUnreadCountReset, nil);
+	NSMutableDictionary *removed = [NSMutableDictionary dictionaryWithCapacity:paths.count];
+	for (NSString *path in paths)
+		removed[path] = [NSNull null];
+	PostNotification(kNotificationFeedTreeChanged, removed); // will also update total unread count
 }
 
 - (void)openImportDialog {
@@ -231,6 +260,11 @@
 
 /// Returning @c NO will result in a Action-Not-Available-Buzzer sound
 - (BOOL)respondsToSelector:(SEL)aSelector {
+	if (_importInProgress && (aSelector == @selector(undo:) || aSelector == @selector(redo:) || aSelector == @selector(remove:)
+							  || aSelector == @selector(addFeed) || aSelector == @selector(addGroup) || aSelector == @selector(addSeparator)
+							  || aSelector == @selector(editSelectedItem) || aSelector == @selector(doubleClickOutlineView:)
+							  || aSelector == @selector(openImportDialog)))
+		return NO;
 	if (aSelector == @selector(undo:))
 		return [self.undoManager canUndo] && self.undoManager.groupingLevel == 0 && ![UpdateScheduler isUpdating];
 	if (aSelector == @selector(redo:))
@@ -311,7 +345,7 @@
 	NSUInteger index = selNode.childNodes.count;
 	FeedGroup *fg = [FeedGroup newGroup:type inContext:self.dataStore.managedObjectContext];
 	[self.dataStore insertObject:fg atArrangedObjectIndexPath:[selNode.indexPath indexPathByAddingIndex:index]];
-	[fg setParent:selObj andSortIndex:(int32_t)index];
+	[fg setParent:selObj andSortIndex:(int32_t)index siblings:index + 1];
 	return fg;
 }
 
@@ -359,12 +393,13 @@
 	return self.dataStore.selectedNodes.firstObject;
 }
 
-/// Loop over all descendants and update @c sortIndex @c (FeedGroup) as well as all @c indexPath @c (Feed)
+/// Update @c sortIndex of all children. Nested interval and @c indexPath are only recalculated for changed subtrees.
 - (void)restoreOrderingAndIndexPathStr:(NSArray<NSTreeNode*>*)parentsList {
 	for (NSTreeNode *parent in parentsList) {
-		for (NSUInteger i = 0; i < parent.childNodes.count; i++) {
-			FeedGroup *fg = parent.childNodes[i].representedObject;
-			[fg setSortIndexIfChanged:(int32_t)i];
+		NSArray<NSTreeNode*> *children = parent.childNodes;
+		for (NSUInteger i = 0; i < children.count; i++) {
+			FeedGroup *fg = children[i].representedObject;
+			[fg setSortIndexIfChanged:(int32_t)i siblings:children.count];
 		}
 	}
 }
@@ -1,6 +1,7 @@
 #import "SettingsFeedsView.h"
 #import "StoreCoordinator.h"
 #import "FeedGroup+Ext.h"
+#import "FeedMeta+Ext.h"
 #import "DrawImage.h"
 #import "SettingsFeeds.h"
 #import "NSDate+Ext.h"
@@ -206,7 +207,10 @@ NSUserInterfaceItemIdentifier const CustomCellRefresh = @"RefreshColumnCell";
 	NSString *str = @"";
 	if (fg.type == FEED) {
 		int32_t refresh = fg.feed.meta.refresh;
-		str = (refresh <= 0 ? @"∞" : [NSDate intStringForInterval:refresh]); // ∞ ƒ Ø
+		if (refresh == kFeedRefreshAuto) // automatic, learned interval
+			str = [@"≈ " stringByAppendingString:[NSDate floatStringForInterval:[fg.feed.meta effectiveRefresh]]];
+		else
+			str = (refresh == 0 ? @"∞" : [NSDate intStringForInterval:refresh]); // ∞ ƒ Ø
 	}
 	self.textField.objectValue = str;
 	self.textField.textColor = (str.length > 1 ? [NSColor controlTextColor] : [NSColor disabledControlTextColor]);
@@ -19,6 +19,7 @@
 @property (strong) IBOutlet RegexConverterView *view; // override
 
 @property (strong) NSString *theData; // not "copy" because generated in initializer
+@property (strong) RegexFeedJob *job; // currently running preview evaluation
 @end
 
 @implementation RegexConverterController
@@ -32,6 +33,10 @@
 	return diag;
 }
 
+- (void)dealloc {
+	[self.job cancel];
+}
+
 - (RegexConverterModal *)getModalSheet {
 	if (!self.modalSheet) {
 		self.modalSheet = [[RegexConverterModal alloc] initWithView:self.view];
@@ -95,27 +100,60 @@
 	return tmp;
 }
 
+/// Cancel previous evaluation and start new one in background. Partial results are shown while processing.
 - (void)controlTextDidEndEditing:(NSNotification*)obj {
+	[self.job cancel];
+	self.job = nil;
 	if (self.view.entry.stringValue.length == 0) {
 		[self updateOutput:self.theData];
 		return;
 	}
 	
-	NSError *err = nil;
-	NSArray<RegexFeedEntry*> *matches = [[self regexParser] process:self.theData error:&err];
-	if (err) {
-		[self updateOutput:[NSString stringWithFormat:@"%@\n––––\n%@",
-							err.localizedDescription, err.localizedRecoverySuggestion]];
-		return;
-	}
-	
+	RegexFeedJob *job = [RegexFeedJob withDefaultBudget];
+	RegexFeed *parser = [self regexParser];
+	NSString *data = self.theData;
+	self.job = job;
+	__weak typeof(self) weakSelf = self;
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+		NSError *err = nil;
+		NSArray<RegexFeedEntry*> *matches = [parser process:data job:job progress:^(NSArray<RegexFeedEntry*> *partial) {
+			NSString *text = [weakSelf formatEntries:partial];
+			dispatch_async(dispatch_get_main_queue(), ^{
+				if (weakSelf.job == job && !job.aborted)
+					[weakSelf updateOutput:text];
+			});
+		} error:&err];
+		NSMutableString *text = [NSMutableString new];
+		if (err) {
+			[text appendFormat:@"%@\n––––\n%@\n\n----------\n\n", err.localizedDescription, err.localizedRecoverySuggestion];
+		}
+		[text appendString:[weakSelf formatTiming:job]];
+		[text appendString:[weakSelf formatEntries:matches]];
+		dispatch_async(dispatch_get_main_queue(), ^{
+			if (weakSelf.job == job) {
+				weakSelf.job = nil;
+				[weakSelf updateOutput:text];
+			}
+		});
+	});
+}
+
+/// @return Preview string of all matched entries.
+- (NSString*)formatEntries:(NSArray<RegexFeedEntry*>*)matches {
 	NSMutableString *rv = [NSMutableString new];
 	for (RegexFeedEntry *entry in matches) {
 		[rv appendFormat:@"%@\n\n$_href: %@\n$_title: %@\n$_date: %@ -> %@\n$_description: %@\n\n----------\n\n",
 		 entry.rawMatch, entry.href, entry.title, entry.dateString, entry.date, entry.desc];
 	}
-	
-	[self updateOutput:rv];
+	return rv;
+}
+
+/// @return Single line with accumulated match time per pattern.
+- (NSString*)formatTiming:(RegexFeedJob*)job {
+	return [NSString stringWithFormat:@"Timing: entry %.1f ms, href %.1f ms, title %.1f ms, description %.1f ms, date %.1f ms\n\n----------\n\n",
+			[job durationForField:RegexFieldEntry] * 1000, [job durationForField:RegexFieldHref] * 1000,
+			[job durationForField:RegexFieldTitle] * 1000, [job durationForField:RegexFieldDesc] * 1000,
+			[job durationForField:RegexFieldDate] * 1000];
 }
 
 - (void)updateOutput:(NSString *)text {
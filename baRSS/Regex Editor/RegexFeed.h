@@ -14,17 +14,46 @@ NS_ASSUME_NONNULL_BEGIN
 @end
 
 
+typedef NS_ENUM(NSInteger, RegexField) {
+	RegexFieldEntry, RegexFieldHref, RegexFieldTitle, RegexFieldDesc, RegexFieldDate,
+	RegexFieldCount
+};
+
+/**
+ Single evaluation of @c RegexFeed. Can be canceled from any thread.
+ Budget applies to each pattern evaluation separately, i.e., one entry match or one field within an entry.
+ Large documents with many entries are therefore not aborted as long as every single evaluation is fast.
+ */
+@interface RegexFeedJob : NSObject
+/// Max. wall-clock time of a single pattern evaluation in seconds. @c 0 means unlimited.
+@property (atomic, assign) NSTimeInterval timeBudget;
+/// Max. number of progress reports (@c NSMatchingReportProgress ) of a single pattern evaluation. @c 0 means unlimited.
+@property (atomic, assign) NSUInteger stepBudget;
+/// @c YES if job was canceled or budget was exceeded.
+@property (readonly) BOOL aborted;
+
++ (instancetype)withDefaultBudget;
+- (void)cancel;
+- (NSTimeInterval)durationForField:(RegexField)field;
+@end
+
+
 @interface RegexFeed : NSObject
-@property (nullable, copy) NSString *rxEntry;
-@property (nullable, copy) NSString *rxHref;
-@property (nullable, copy) NSString *rxTitle;
-@property (nullable, copy) NSString *rxDesc;
-@property (nullable, copy) NSString *rxDate;
-@property (nullable, copy) NSString *dateFormat;
+@property (nonatomic, nullable, copy) NSString *rxEntry;
+@property (nonatomic, nullable, copy) NSString *rxHref;
+@property (nonatomic, nullable, copy) NSString *rxTitle;
+@property (nonatomic, nullable, copy) NSString *rxDesc;
+@property (nonatomic, nullable, copy) NSString *rxDate;
+@property (nonatomic, nullable, copy) NSString *dateFormat;
 
 + (RegexFeed *)from:(RegexConverter*)regex;
++ (void)invalidateCache:(RegexConverter*)regex;
 
 - (NSArray<RegexFeedEntry*>*)process:(NSString*)rawData error:(NSError * __autoreleasing *)err;
+- (NSArray<RegexFeedEntry*>*)process:(NSString*)rawData job:(RegexFeedJob*)job progress:(nullable void(^)(NSArray<RegexFeedEntry*> *partial))block error:(NSError * __autoreleasing *)err;
+#ifdef DEBUG
++ (void)benchmarkLargePage;
+#endif
 @end
 
 NS_ASSUME_NONNULL_END
@@ -1,5 +1,18 @@
 #import "RegexFeed.h"
 #import "RegexConverter+Ext.h"
+#import "NSError+Ext.h"
+#import "Constants.h"
+
+#include <stdatomic.h>
+
+/// Number of entries processed in parallel before progress is reported.
+static NSUInteger const kParallelEntryThreshold = 64;
+/// Default time budget per pattern evaluation (seconds). Used for scheduled downloads and regex editor.
+static NSTimeInterval const kRegexTimeBudget = 2.0;
+/// Default step budget per pattern evaluation (progress reports of @c NSRegularExpression ).
+static NSUInteger const kRegexStepBudget = 100000;
+
+static inline uint64_t NowNanos(void) { return clock_gettime_nsec_np(CLOCK_UPTIME_RAW); }
 
 @interface RegexFeedEntry()
 @property (nullable, copy) NSString *href;
@@ -8,70 +21,275 @@
 @property (nullable, copy) NSString *dateString;
 @property (nullable, retain) NSDate *date;
 
-@property (nullable, copy) NSString *rawMatch;
+@property (nullable, strong) NSString *source; // full document, rawMatch is created on demand
+@property (assign) NSRange range;
 @end
 
 @implementation RegexFeedEntry
+- (nullable NSString*)rawMatch { return [self.source substringWithRange:self.range]; }
+@end
+
+
+// ################################################################
+// #  MARK: - RegexFeedJob -
+// ################################################################
+
+@interface RegexFeedJob() {
+	_Atomic(uint64_t) _nanos[RegexFieldCount];
+	atomic_bool _aborted;
+	atomic_bool _canceled;
+}
+@property (atomic, assign) RegexField abortedField;
 @end
 
+@implementation RegexFeedJob
+
+/// @return New job with default time and step budget.
++ (instancetype)withDefaultBudget {
+	RegexFeedJob *job = [RegexFeedJob new];
+	job.timeBudget = kRegexTimeBudget;
+	job.stepBudget = kRegexStepBudget;
+	return job;
+}
+
+- (BOOL)aborted { return atomic_load(&_aborted); }
+
+/// Stop evaluation as soon as possible. Already processed entries are kept.
+- (void)cancel {
+	atomic_store(&_canceled, true);
+	atomic_store(&_aborted, true);
+}
+
+/// @return Accumulated match time of @c field in seconds.
+- (NSTimeInterval)durationForField:(RegexField)field {
+	return atomic_load(&_nanos[field]) / 1e9;
+}
+
+/// Add match time of a single evaluation (for reporting only, not part of the budget).
+- (void)addDuration:(uint64_t)nanos field:(RegexField)field {
+	atomic_fetch_add(&_nanos[field], nanos);
+}
+
+/**
+ Called periodically during a long-running match.
+ @param start Begin of the current evaluation (wall clock).
+ @param steps Number of progress reports since @c start .
+ @return @c YES if evaluation should stop.
+ */
+- (BOOL)shouldAbort:(RegexField)field since:(uint64_t)start steps:(NSUInteger)steps {
+	if (atomic_load(&_aborted))
+		return YES;
+	if ((self.stepBudget > 0 && steps > self.stepBudget) || (self.timeBudget > 0 && NowNanos() - start > self.timeBudget * 1e9)) {
+		self.abortedField = field;
+		atomic_store(&_aborted, true);
+		return YES;
+	}
+	return NO;
+}
+
+/// @return @c nil if job finished normally. Otherwise, user canceled or budget error.
+- (nullable NSError*)error {
+	if (!atomic_load(&_aborted))
+		return nil;
+	if (atomic_load(&_canceled))
+		return [NSError canceledByUser];
+	static NSString* const names[] = { @"entry", @"href", @"title", @"description", @"date" };
+	return [NSError regexBudgetExceeded:names[self.abortedField]];
+}
+
+@end
+
+
+// ################################################################
+// #  MARK: - RegexFeed -
+// ################################################################
+
+
+@interface RegexFeed()
+// Compiled program (nil until first use)
+@property (nonatomic, assign) BOOL compiled;
+@property (nonatomic, strong) NSRegularExpression *reEntry, *reHref, *reTitle, *reDesc, *reDate;
+@property (nonatomic, strong) NSDateFormatter *dateFormatter;
+@property (nonatomic, strong) NSError *compileError;
+@end
 
 @implementation RegexFeed
 
+/// Compiled @c RegexFeed per @c RegexConverter. Entries are removed by the @c set*IfChanged: setters.
+static NSCache<NSManagedObjectID*, RegexFeed*>* ProgramCache(void) {
+	static NSCache *cache;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		cache = [NSCache new];
+		cache.countLimit = 100;
+	});
+	return cache;
+}
+
+/// @return Cached instance (with compiled regular expressions) or new instance if patterns changed.
 + (RegexFeed *)from:(RegexConverter*)regex {
-	RegexFeed *x = [RegexFeed new];
+	NSManagedObjectID *oid = regex.objectID;
+	RegexFeed *x = oid.isTemporaryID ? nil : [ProgramCache() objectForKey:oid];
+	if (x && [x isEqualToConverter:regex]) // e.g., undo will change values without setter
+		return x;
+	x = [RegexFeed new];
 	x.rxEntry = regex.entry;
 	x.rxHref = regex.href;
 	x.rxTitle = regex.title;
 	x.rxDesc = regex.desc;
 	x.rxDate = regex.date;
 	x.dateFormat = regex.dateFormat;
+	if (!oid.isTemporaryID)
+		[ProgramCache() setObject:x forKey:oid];
 	return x;
 }
 
+/// Remove compiled program of @c regex from cache.
++ (void)invalidateCache:(RegexConverter*)regex {
+	[ProgramCache() removeObjectForKey:regex.objectID];
+}
+
+/// Compare strings, treating @c nil and empty string the same.
+static inline BOOL SameStr(NSString *a, NSString *b) {
+	return (a.length == 0) ? (b.length == 0) : [a isEqualToString:b];
+}
+
+/// @return @c YES if all patterns are equal.
+- (BOOL)isEqualToConverter:(RegexConverter*)regex {
+	return SameStr(_rxEntry, regex.entry) && SameStr(_rxHref, regex.href) && SameStr(_rxTitle, regex.title)
+		&& SameStr(_rxDesc, regex.desc) && SameStr(_rxDate, regex.date) && SameStr(_dateFormat, regex.dateFormat);
+}
+
+#pragma mark - Setter
+
+- (void)setRxEntry:(NSString*)str   { _rxEntry = [str copy];    _compiled = NO; }
+- (void)setRxHref:(NSString*)str    { _rxHref = [str copy];     _compiled = NO; }
+- (void)setRxTitle:(NSString*)str   { _rxTitle = [str copy];    _compiled = NO; }
+- (void)setRxDesc:(NSString*)str    { _rxDesc = [str copy];     _compiled = NO; }
+- (void)setRxDate:(NSString*)str    { _rxDate = [str copy];     _compiled = NO; }
+- (void)setDateFormat:(NSString*)str { _dateFormat = [str copy]; _compiled = NO; }
+
+#pragma mark - Process
+
+/// Compile all regular expressions and date formatter once. Errors are stored in @c compileError.
+- (void)compile {
+	@synchronized (self) {
+		if (_compiled)
+			return;
+		NSError *err = nil;
+		self.reEntry = [self regex:_rxEntry error:&err];
+		if (self.reEntry) {
+			self.reDate = [self regex:_rxDate error:&err];
+			self.reDesc = [self regex:_rxDesc error:&err];
+			self.reTitle = [self regex:_rxTitle error:&err];
+			self.reHref = [self regex:_rxHref error:&err];
+		}
+		NSDateFormatter *dateFormatter = [NSDateFormatter new];
+		[dateFormatter setDateFormat:_dateFormat];
+		[dateFormatter setTimeZone:[NSTimeZone timeZoneWithName:@"UTC"]];
+		// TODO: we probably need to handle locale. Especially for "d. MMM" like "3. Dec"
+		self.dateFormatter = dateFormatter;
+		self.compileError = err;
+		_compiled = YES;
+	}
+}
+
+/// Evaluate with default budget. If budget is exceeded, return empty list and set @c err.
 - (NSArray<RegexFeedEntry*>*)process:(NSString*)rawData error:(NSError * __autoreleasing *)err {
-	NSRegularExpression *re_entries = [self regex:_rxEntry error:err];
-	if (!re_entries) {
+	RegexFeedJob *job = [RegexFeedJob withDefaultBudget];
+	NSArray<RegexFeedEntry*> *rv = [self process:rawData job:job progress:nil error:err];
+	return job.aborted ? @[] : rv;
+}
+
+/**
+ Evaluate all patterns on @c rawData. Entries are processed in batches (in parallel).
+ 
+ @param job Evaluation is stopped if @c job is canceled or exceeds its budget. @c err is set accordingly.
+ @param block Called after each batch with all entries processed so far (on a background thread).
+ @return All processed entries. If aborted, only those entries that were processed before.
+ */
+- (NSArray<RegexFeedEntry*>*)process:(NSString*)rawData job:(RegexFeedJob*)job progress:(nullable void(^)(NSArray<RegexFeedEntry*> *partial))block error:(NSError * __autoreleasing *)err {
+	[self compile];
+	if (err && self.compileError) {
+		*err = self.compileError;
+	}
+	if (!self.reEntry) {
 		return @[];
 	}
-	NSDateFormatter *dateFormatter = [NSDateFormatter new];
-	[dateFormatter setDateFormat:_dateFormat];
-	[dateFormatter setTimeZone:[NSTimeZone timeZoneWithName:@"UTC"]];
-	// TODO: we probably need to handle locale. Especially for "d. MMM" like "3. Dec"
-
-	NSMutableArray<RegexFeedEntry*> *rv = [NSMutableArray new];
-	NSRegularExpression *re4 = [self regex:_rxDate error:err];
-	NSRegularExpression *re3 = [self regex:_rxDesc error:err];
-	NSRegularExpression *re2 = [self regex:_rxTitle error:err];
-	NSRegularExpression *re1 = [self regex:_rxHref error:err];
-	NSArray<NSTextCheckingResult*> *matches = [re_entries matchesInString:rawData options:0 range:NSMakeRange(0, rawData.length)];
-	
-	for (NSTextCheckingResult *match in matches) {
-		NSString *subdata = [rawData substringWithRange:match.range];
-		RegexFeedEntry *entry = [[RegexFeedEntry alloc] init];
-		entry.rawMatch = subdata;
-		entry.href = [self firstMatch:subdata re:re1];
-		entry.title = [self firstMatch:subdata re:re2];
-		entry.desc = [self firstMatch:subdata re:re3];
-		entry.dateString = [self firstMatch:subdata re:re4];
-		entry.date = (_dateFormat.length && entry.dateString.length) ? [dateFormatter dateFromString:entry.dateString] : nil;
-		[rv addObject:entry];
-	};
+	NSMutableArray<RegexFeedEntry*> *rv = [NSMutableArray array];
+	uint64_t start = NowNanos();
+	__block uint64_t since = start; // budget is per entry match
+	__block NSUInteger steps = 0;
+	[self.reEntry enumerateMatchesInString:rawData options:NSMatchingReportProgress range:NSMakeRange(0, rawData.length) usingBlock:^(NSTextCheckingResult * _Nullable match, NSMatchingFlags flags, BOOL * _Nonnull stop) {
+		if (match) {
+			RegexFeedEntry *entry = [[RegexFeedEntry alloc] init];
+			entry.source = rawData;
+			entry.range = match.range;
+			[rv addObject:entry];
+			since = NowNanos();
+			steps = 0;
+		}
+		if ([job shouldAbort:RegexFieldEntry since:since steps:++steps])
+			*stop = YES;
+	}];
+	[job addDuration:NowNanos() - start field:RegexFieldEntry];
+	// entries are independent, fill fields concurrently in batches
+	NSUInteger done = 0;
+	while (done < rv.count && !job.aborted) {
+		NSUInteger batch = MIN(kParallelEntryThreshold, rv.count - done);
+		dispatch_apply(batch, DISPATCH_APPLY_AUTO, ^(size_t i) {
+			[self fillEntry:rv[done + i] source:rawData job:job];
+		});
+		if (!job.aborted) {
+			done += batch;
+			if (block) block([rv subarrayWithRange:NSMakeRange(0, done)]);
+		}
+	}
+	if (job.aborted) {
+		if (err) *err = [job error];
+		return [rv subarrayWithRange:NSMakeRange(0, done)];
+	}
 	return rv;
 }
 
+/// Set all fields of @c entry. Each field stops at the first match within the entry range.
+- (void)fillEntry:(RegexFeedEntry*)entry source:(NSString*)str job:(RegexFeedJob*)job {
+	NSRange range = entry.range;
+	entry.href = [self firstMatch:str range:range re:self.reHref job:job field:RegexFieldHref];
+	entry.title = [self firstMatch:str range:range re:self.reTitle job:job field:RegexFieldTitle];
+	entry.desc = [self firstMatch:str range:range re:self.reDesc job:job field:RegexFieldDesc];
+	entry.dateString = [self firstMatch:str range:range re:self.reDate job:job field:RegexFieldDate];
+	entry.date = (_dateFormat.length && entry.dateString.length) ? [self.dateFormatter dateFromString:entry.dateString] : nil;
+}
+
 - (nullable NSRegularExpression*)regex:(NSString*)pattern error:(NSError * __autoreleasing *)err {
 	if (pattern.length == 0) {
 		return nil;
 	}
-	NSRegularExpression *re = [[NSRegularExpression alloc] initWithPattern:pattern options:NSRegularExpressionDotMatchesLineSeparators error:err];
-	if (*err) {
+	NSError *e = nil;
+	NSRegularExpression *re = [[NSRegularExpression alloc] initWithPattern:pattern options:NSRegularExpressionDotMatchesLineSeparators error:&e];
+	if (e) {
+		*err = e; // keep previous error if this one succeeds
 		return nil;
 	}
 	return re;
 }
 
-- (nonnull NSString*)firstMatch:(NSString*)str re:(NSRegularExpression*)re {
-	NSTextCheckingResult *match = [[re matchesInString:str options:0 range:NSMakeRange(0, str.length)] firstObject];
+- (nonnull NSString*)firstMatch:(NSString*)str range:(NSRange)range re:(NSRegularExpression*)re job:(RegexFeedJob*)job field:(RegexField)field {
+	if (!re || job.aborted)
+		return @"";
+	__block NSTextCheckingResult *match = nil;
+	__block NSUInteger steps = 0;
+	uint64_t start = NowNanos();
+	[re enumerateMatchesInString:str options:NSMatchingReportProgress range:range usingBlock:^(NSTextCheckingResult * _Nullable result, NSMatchingFlags flags, BOOL * _Nonnull stop) {
+		if (result) {
+			match = result;
+			*stop = YES;
+		} else if ([job shouldAbort:field since:start steps:++steps]) {
+			*stop = YES;
+		}
+	}];
+	[job addDuration:NowNanos() - start field:field];
 	if (match) {
 		if (match.numberOfRanges < 2) {
 			return NSLocalizedString(@"Regex error: Missing match-group? ('outer(.*?)text')", nil);
@@ -83,4 +301,47 @@
 	return @"";
 }
 
+
+#ifdef DEBUG
+#pragma mark - Benchmark (DEBUG)
+
+/// @return HTML page with @c count entries of roughly @c size bytes each.
+static NSString* BenchmarkPage(NSUInteger count, NSUInteger size) {
+	NSString *filler = [@"" stringByPaddingToLength:size withString:@"Lorem ipsum dolor sit amet, consectetur adipiscing elit. " startingAtIndex:0];
+	NSMutableString *html = [NSMutableString stringWithString:@"<html><body>\n"];
+	for (NSUInteger i = 0; i < count; i++) {
+		[html appendFormat:@"<article><h2>Article %lu</h2><a href=\"https://example.org/%lu\">more</a>"
+		 @"<time>2020-01-%02lu</time><p>%@</p></article>\n", i, i, i % 28 + 1, filler];
+	}
+	[html appendString:@"</body></html>"];
+	return html;
+}
+
+/**
+ Developer tool. Print duration of @c process:error: for a 2 MB page with 1500 entries using the default budget.
+ The page is valid, hence the evaluation must not be aborted. Started with @c barss:config/benchmark/regex
+ */
++ (void)benchmarkLargePage {
+	dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+		RegexFeed *rx = [RegexFeed new];
+		rx.rxEntry = @"<article>(.*?)</article>";
+		rx.rxHref = @"href=\"([^\"]*)\"";
+		rx.rxTitle = @"<h2>(.*?)</h2>";
+		rx.rxDesc = @"<p>(.*?)</p>";
+		rx.rxDate = @"<time>(.*?)</time>";
+		rx.dateFormat = @"yyyy-MM-dd";
+		NSString *page = BenchmarkPage(1500, 1300);
+		printf("--- regex page %lu bytes ---\n", [page lengthOfBytesUsingEncoding:NSUTF8StringEncoding]);
+		__block NSArray<RegexFeedEntry*> *entries;
+		__block NSError *error;
+		benchmark("process", ^{
+			NSError *err = nil;
+			entries = [rx process:page error:&err];
+			error = err;
+		});
+		printf("entries: %lu (%s)\n", entries.count, error ? error.localizedDescription.UTF8String : "ok");
+	});
+}
+#endif
+
 @end
@@ -1,5 +1,5 @@
 @import Cocoa;
-@class BarStatusItem;
+@class BarStatusItem, Feed;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -7,6 +7,7 @@ NS_ASSUME_NONNULL_BEGIN
 @property (assign) BOOL showHidden;
 - (instancetype)init NS_UNAVAILABLE;
 - (instancetype)initWithStatusItem:(BarStatusItem*)statusItem NS_DESIGNATED_INITIALIZER;
+- (void)feedUpdated:(Feed*)feed;
 @end
 
 NS_ASSUME_NONNULL_END
@@ -12,7 +12,6 @@
 
 @interface BarMenu()
 @property (weak) BarStatusItem *statusItem;
-@property (strong) MapUnreadTotal *unreadMap;
 @end
 
 
@@ -21,10 +20,7 @@
 - (instancetype)initWithStatusItem:(BarStatusItem*)statusItem {
 	self = [super init];
 	self.statusItem = statusItem;
-	// TODO: move unread counts to status item and keep in sync when changing feeds in preferences
-	self.unreadMap = [[MapUnreadTotal alloc] initWithCoreData: [StoreCoordinator countAggregatedUnread]];
-	// Register for notifications
-	RegisterNotification(kNotificationArticlesUpdated, @selector(articlesUpdated:), self);
+	// Register for notifications (article updates are forwarded by status item, see feedUpdated:)
 	RegisterNotification(kNotificationFeedIconUpdated, @selector(feedIconUpdated:), self);
 	return self;
 }
@@ -47,9 +43,12 @@
 
 /// Populate menu with items.
 - (void)menuNeedsUpdate:(NSMenu*)menu {
+#ifdef DEBUG
+	NSUInteger fetches = [StoreCoordinator fetchCount], faults = [StoreCoordinator faultCount];
+#endif
 	if (menu.isFeedMenu) {
 		Feed *feed = [StoreCoordinator feedWithIndexPath:menu.titleIndexPath inContext:nil];
-		[self setArticles:[feed sortedArticles] forMenu:menu];
+		[self setArticles:[self articlesForMenu:feed] forMenu:menu];
 	} else {
 		NSArray<FeedGroup*> *groups = [StoreCoordinator sortedFeedGroupsWithParent:menu.parentItem.representedObject inContext:nil];
 		if (groups.count == 0) {
@@ -58,15 +57,27 @@
 			[self setFeedGroups:groups forMenu:menu];
 		}
 	}
+#ifdef DEBUG
+	NSLog(@"menu %@ opened: %lu fetches, %lu faults", menu.title, [StoreCoordinator fetchCount] - fetches, [StoreCoordinator faultCount] - faults);
+#endif
+}
+
+/// @return Sorted articles of @c feed . Fetches only the articles that will be displayed (see @c setArticles:forMenu: ).
+- (NSArray<FeedArticle*>*)articlesForMenu:(nullable Feed*)feed {
+	NSInteger mc = UserPrefsInt(Pref_articleCountLimit);
+	if (!feed || mc == 0)
+		return @[];
+	BOOL onlyUnread = (UserPrefsBool(Pref_articleUnreadOnly) && !_showHidden);
+	return [StoreCoordinator sortedArticlesWithParent:feed unreadOnly:onlyUnread limit:(mc < 0 ? 0 : (NSUInteger)mc) inContext:nil];
 }
 
 /// Generate items for @c FeedGroup menu.
 - (void)setFeedGroups:(NSArray<FeedGroup*>*)sortedList forMenu:(NSMenu*)menu {
 	[menu insertDefaultHeader];
 	for (FeedGroup *fg in sortedList) {
-		[menu insertFeedGroupItem:fg withUnread:self.unreadMap showHidden:_showHidden].submenu.delegate = self;
+		[menu insertFeedGroupItem:fg withUnread:self.statusItem.unreadMap showHidden:_showHidden].submenu.delegate = self;
 	}
-	[menu setHeaderHasUnread:self.unreadMap[menu.titleIndexPath]];
+	[menu setHeaderHasUnread:self.statusItem.unreadMap[menu.titleIndexPath]];
 }
 
 /// Generate items for @c FeedArticles menu.
@@ -85,7 +96,7 @@
 			[menu addItem:[fa newMenuItem]];
 		}
 	}
-	[menu setHeaderHasUnread:self.unreadMap[menu.titleIndexPath]];
+	[menu setHeaderHasUnread:self.statusItem.unreadMap[menu.titleIndexPath]];
 }
 
 
@@ -105,30 +116,25 @@
 	return YES;
 }
 
-/// Callback method fired when feed has been updated in the background.
-- (void)articlesUpdated:(NSNotification*)notify {
-	Feed *feed;
-	NSMenuItem *item;
-	if ([self findDeepest:notify.object feed:&feed menuItem:&item]) {
-		// 1. update in-memory unread count
-		UnreadTotal *updated = [UnreadTotal new];
-		updated.total = feed.articles.count;
-		for (FeedArticle *fa in feed.articles) {
-			if (fa.unread) updated.unread += 1;
-		}
-		[self.unreadMap updateAllCounts:updated forPath:feed.indexPath];
-		// 2. rebuild articles menu if it is open
+/**
+ Called by status item when feed has been updated in the background.
+ In-memory unread counts are already updated at this point (see @c BarStatusItem.unreadMap ).
+ */
+- (void)feedUpdated:(Feed*)feed {
+	NSMenuItem *item = [self.statusItem.mainMenu deepestItemWithPath:feed.indexPath];
+	if (item) {
+		// 1. rebuild articles menu if it is open
 		if (item.submenu.isFeedMenu) { // menu item is visible
 			item.title = feed.group.anyName; // will replace (no title)
 			item.image = [feed iconImage16];
-			item.enabled = (feed.articles.count > 0);
+			item.enabled = (feed.totalCount > 0);
 			if (item.submenu.numberOfItems > 0) { // replace articles menu
 				[item.submenu removeAllItems];
-				[self setArticles:[feed sortedArticles] forMenu:item.submenu];
+				[self setArticles:[self articlesForMenu:feed] forMenu:item.submenu];
 			}
 		}
-		// 3. set unread count & enabled header for all parents
-		NSArray<UnreadTotal*> *itms = [self.unreadMap itemsForPath:item.submenu.titleIndexPath create:NO];
+		// 2. set unread count & enabled header for all parents
+		NSArray<UnreadTotal*> *itms = [self.statusItem.unreadMap itemsForPath:item.submenu.titleIndexPath create:NO];
 		for (UnreadTotal *uct in itms.reverseObjectEnumerator) {
 			if (item) { // nil on last loop (aka main menu, see below)
 				[item.submenu setHeaderHasUnread:uct];
@@ -1,9 +1,12 @@
 @import Cocoa;
+@class MapUnreadTotal;
 
 NS_ASSUME_NONNULL_BEGIN
 
 @interface BarStatusItem : NSObject <NSMenuDelegate>
 @property (weak, readonly) NSMenu *mainMenu;
+/// Aggregated unread counts of all feeds. Kept in sync with background updates and changes in preferences.
+@property (readonly) MapUnreadTotal *unreadMap;
 
 - (void)setUnreadCountAbsolute:(NSUInteger)count;
 - (void)setUnreadCountRelative:(NSInteger)count;
@@ -9,11 +9,15 @@
 #import "NSView+Ext.h"
 #import "NSColor+Ext.h"
 #import "NSMenu+Ext.h"
+#import "MapUnreadTotal.h"
+#import "Feed+Ext.h"
 
 @interface BarStatusItem()
 @property (strong) BarMenu *barMenu;
 @property (strong) NSStatusItem *statusItem;
 @property (assign) NSInteger unreadCountTotal;
+/// Cached unread counts per feed and group. @c nil if it must be reloaded from core data.
+@property (strong, nullable) MapUnreadTotal *cachedUnreadMap;
 /// Set to `true` if user toggled the `"Show hidden feeds"` menu option.
 @property (assign) BOOL optShowHidden;
 /// Set to `true` if menu bar was opened while holding down option-key.
@@ -36,6 +40,8 @@
 	RegisterNotification(kNotificationNetworkStatusChanged, @selector(networkChanged:), self);
 	RegisterNotification(kNotificationTotalUnreadCountChanged, @selector(unreadCountChanged:), self);
 	RegisterNotification(kNotificationTotalUnreadCountReset, @selector(unreadCountReset:), self);
+	RegisterNotification(kNotificationArticlesUpdated, @selector(articlesUpdated:), self);
+	RegisterNotification(kNotificationFeedTreeChanged, @selector(feedTreeChanged:), self);
 	return self;
 }
 
@@ -56,6 +62,9 @@
 /// Fired when a single feed has been updated. Object contains relative unread count change.
 - (void)unreadCountChanged:(NSNotification*)notify {
 	[self setUnreadCountRelative:[[notify object] integerValue]];
+	// No indexPath given. While the menu is open, background updates will follow up with kNotificationArticlesUpdated
+	if (!self.barMenu)
+		self.cachedUnreadMap = nil;
 }
 
 /**
@@ -63,6 +72,7 @@
  If @c object is @c nil perform core data fetch on total unread count and update icon.
  */
 - (void)unreadCountReset:(NSNotification*)notify {
+	self.cachedUnreadMap = nil;
 	if (notify.object) // set unread count directly
 		[self setUnreadCountAbsolute:[[notify object] unsignedIntegerValue]];
 	else
@@ -70,8 +80,55 @@
 }
 
 
+/// Fired when articles of a single feed were modified. Update cached unread counts and forward to open menu.
+- (void)articlesUpdated:(NSNotification*)notify {
+	Feed *feed = [[StoreCoordinator getMainContext] objectWithID:notify.object];
+	if (![feed isKindOfClass:[Feed class]])
+		return;
+	if (self.cachedUnreadMap) { // stored counts, no need to load articles
+		UnreadTotal *updated = [UnreadTotal new];
+		updated.total = (NSUInteger)MAX(0, feed.totalCount);
+		updated.unread = feed.countUnread;
+		[self.cachedUnreadMap updateAllCounts:updated forPath:feed.indexPath];
+	}
+	[self.barMenu feedUpdated:feed];
+}
+
+/// Fired when items were moved or deleted in preferences. Apply changes to cached unread counts (or reload if unknown).
+- (void)feedTreeChanged:(NSNotification*)notify {
+	NSDictionary<NSString*, id> *changes = notify.object;
+	MapUnreadTotal *map = self.cachedUnreadMap;
+	if (!map || !changes) {
+		self.cachedUnreadMap = nil;
+		[self asyncReloadUnreadCount];
+		return;
+	}
+	NSMutableArray<NSString*> *moveFrom = [NSMutableArray array], *moveTo = [NSMutableArray array], *removed = [NSMutableArray array];
+	for (NSString *path in changes) {
+		id dest = changes[path];
+		if (dest == [NSNull null]) {
+			[removed addObject:path];
+		} else if (![dest isEqualToString:path]) {
+			[moveFrom addObject:path];
+			[moveTo addObject:dest];
+		}
+	}
+	[map removeItemsAtPaths:removed];
+	[map moveItemsAtPaths:moveFrom toPaths:moveTo];
+	if (removed.count > 0)
+		[self asyncReloadUnreadCount];
+}
+
+
 #pragma mark - Helper
 
+/// @return Cached unread counts. Will fetch stored counts of all feeds if cache was cleared.
+- (MapUnreadTotal*)unreadMap {
+	if (!self.cachedUnreadMap)
+		self.cachedUnreadMap = [[MapUnreadTotal alloc] initWithCoreData:[StoreCoordinator countAggregatedUnread]];
+	return self.cachedUnreadMap;
+}
+
 /// Assign total unread count value directly.
 - (void)setUnreadCountAbsolute:(NSUInteger)count {
 	NSInteger oldCount = _unreadCountTotal;
@@ -2,6 +2,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// Tree node with aggregated counts of all descendants. Children are indexed by @c FeedGroup.sortIndex
 @interface UnreadTotal : NSObject
 @property (nonatomic, assign) NSUInteger unread;
 @property (nonatomic, assign) NSUInteger total;
@@ -14,10 +15,19 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (NSArray<UnreadTotal*>*)itemsForPath:(NSString*)path create:(BOOL)flag;
 - (void)updateAllCounts:(UnreadTotal*)updated forPath:(NSString*)path;
+- (void)addUnread:(NSInteger)unread total:(NSInteger)total forPath:(NSString*)path;
+// Editing tree structure
+- (void)moveItemAtPath:(NSString*)path toPath:(NSString*)destination;
+- (void)moveItemsAtPaths:(NSArray<NSString*>*)paths toPaths:(NSArray<NSString*>*)destinations;
+- (void)removeItemAtPath:(NSString*)path;
+- (void)removeItemsAtPaths:(NSArray<NSString*>*)paths;
 
 // Keyed subscription
-- (UnreadTotal*)objectForKeyedSubscript:(NSString*)key;
-- (void)setObject:(UnreadTotal*)obj forKeyedSubscript:(NSString*)key;
+- (nullable UnreadTotal*)objectForKeyedSubscript:(NSString*)key;
+
+#ifdef DEBUG
++ (void)benchmark;
+#endif
 @end
 
 NS_ASSUME_NONNULL_END
@@ -1,70 +1,247 @@
 #import "MapUnreadTotal.h"
+#import "Constants.h"
+
+/// Max depth of nested groups. Deeper paths are truncated.
+#define MAX_PATH_DEPTH 64
+
+/// Parse dot separated path (e.g., "1.14.0") into integer array without intermediate strings. @return Path depth.
+static NSUInteger ParseIndexPath(NSString *path, NSUInteger *indices) {
+	const char *s = path.UTF8String;
+	NSUInteger depth = 0;
+	while (s && *s && depth < MAX_PATH_DEPTH) {
+		char *end;
+		unsigned long value = strtoul(s, &end, 10);
+		if (end == s) break; // not a number
+		indices[depth++] = (NSUInteger)value;
+		s = (*end == '.') ? end + 1 : end;
+	}
+	return depth;
+}
+
+/// Compare dot separated paths by their numeric components. Parents are ordered before their children.
+static NSComparisonResult ComparePath(NSString *a, NSString *b) {
+	return [a compare:b options:NSNumericSearch];
+}
+
+
+@interface UnreadTotal()
+@property (nonatomic, weak) UnreadTotal *parent;
+@property (nonatomic, strong) NSPointerArray *children; // sparse, index = sortIndex
+- (NSPointerArray*)childrenCreate;
+@end
+
 
 @interface MapUnreadTotal()
-@property (strong) NSMutableDictionary<NSString*, UnreadTotal*> *map;
+@property (strong) UnreadTotal *root;
 @end
 
 @implementation MapUnreadTotal
 
-- (NSString *)description { return _map.description; }
-- (UnreadTotal*)objectForKeyedSubscript:(NSString*)key { return _map[key]; }
-- (void)setObject:(UnreadTotal*)obj forKeyedSubscript:(NSString*)key { _map[key] = obj; }
+- (NSString *)description { return _root.description; }
+- (UnreadTotal*)objectForKeyedSubscript:(NSString*)key { return [self nodeForPath:key create:NO]; }
 
-/// Perform core data fetch and sum unread counts per @c Feed. Aggregate counts that are grouped in @c FeedGroup.
+/// Use stored unread and total counts per @c Feed. Aggregate counts that are grouped in @c FeedGroup.
 - (instancetype)initWithCoreData:(NSArray<NSDictionary*>*)data {
 	self = [super init];
 	if (self) {
-		_map = [NSMutableDictionary dictionaryWithCapacity:data.count + 1];
-		_map[@""] = [UnreadTotal new];
-		
+		_root = [UnreadTotal new];
 		for (NSDictionary *d in data) {
-			NSUInteger u = [d[@"unread"] unsignedIntegerValue];
-			NSUInteger t = [d[@"total"] unsignedIntegerValue];
-			
-			for (UnreadTotal *uct in [self itemsForPath:d[@"indexPath"] create:YES]) {
-				uct.unread += u;
-				uct.total += t;
-			}
+			UnreadTotal *node = [self nodeForPath:d[@"indexPath"] create:YES];
+			[self addUnread:[d[@"unreadCount"] integerValue] total:[d[@"totalCount"] integerValue] toNode:node];
 		}
 	}
 	return self;
 }
 
-/// @return All group items and deepest item of @c path. If @c flag @c = @c YES non-existing items will be created.
+/**
+ @return All group items and deepest item of @c path. If @c flag @c = @c YES non-existing items will be created.
+ If @c flag @c = @c NO only existing items are returned (at least root).
+ */
 - (NSArray<UnreadTotal*>*)itemsForPath:(NSString*)path create:(BOOL)flag {
-	NSMutableArray<UnreadTotal*> *arr = [NSMutableArray array];
-	NSMutableString *key = [NSMutableString string];
-	[arr addObject:_map[@""]];
-	for (NSString *idx in [path componentsSeparatedByString:@"."]) {
-		if (key.length > 0)
-			[key appendString:@"."];
-		[key appendString:idx];
-		
-		UnreadTotal *a = _map[key];
-		if (!a) {
-			if (!flag) continue; // skip item creation if flag = NO
-			a = [UnreadTotal new];
-			_map[key] = a;
-		}
-		[arr addObject:a];
+	NSUInteger idx[MAX_PATH_DEPTH];
+	NSUInteger depth = ParseIndexPath(path, idx);
+	NSMutableArray<UnreadTotal*> *arr = [NSMutableArray arrayWithCapacity:depth + 1];
+	UnreadTotal *node = _root;
+	[arr addObject:node];
+	for (NSUInteger i = 0; i < depth; i++) {
+		node = [self nodeForIndices:idx + i depth:1 create:flag startingAt:node];
+		if (!node) break;
+		[arr addObject:node];
 	}
 	return arr;
 }
 
 /// Set new values for item at @c path. Updating all group items as well.
 - (void)updateAllCounts:(UnreadTotal*)updated forPath:(NSString*)path {
-	UnreadTotal *previous = _map[path];
-	NSUInteger diffU = (updated.unread - previous.unread);
-	NSUInteger diffT = (updated.total - previous.total);
-	for (UnreadTotal *uct in [self itemsForPath:path create:NO]) {
-		uct.unread += diffU;
-		uct.total += diffT;
+	UnreadTotal *node = [self nodeForPath:path create:YES];
+	[self addUnread:(NSInteger)updated.unread - (NSInteger)node.unread
+			  total:(NSInteger)updated.total - (NSInteger)node.total toNode:node];
+}
+
+/// Add relative count change to item at @c path and all its parents. Runs in @c O(depth).
+- (void)addUnread:(NSInteger)unread total:(NSInteger)total forPath:(NSString*)path {
+	[self addUnread:unread total:total toNode:[self nodeForPath:path create:YES]];
+}
+
+/**
+ Move subtree from @c path (before the move) to @c destination (after the move). Counts of all parents are updated.
+ Following siblings of source are shifted up, following siblings of destination are shifted down (same as @c sortIndex ).
+ */
+- (void)moveItemAtPath:(NSString*)path toPath:(NSString*)destination {
+	[self attachNode:[self detachNodeAtPath:path] atPath:destination];
+}
+
+/**
+ Move multiple subtrees at once (e.g., drag of multiple items). @c paths and @c destinations must have the same order.
+ All sources are detached first (deepest and last first), then inserted in ascending destination order.
+ */
+- (void)moveItemsAtPaths:(NSArray<NSString*>*)paths toPaths:(NSArray<NSString*>*)destinations {
+	NSParameterAssert(paths.count == destinations.count);
+	NSMutableDictionary<NSString*, UnreadTotal*> *detached = [NSMutableDictionary dictionaryWithCapacity:paths.count];
+	NSArray<NSString*> *order = [paths sortedArrayUsingComparator:^NSComparisonResult(NSString *a, NSString *b) {
+		return ComparePath(b, a);
+	}];
+	for (NSString *path in order) {
+		UnreadTotal *node = [self detachNodeAtPath:path];
+		if (node) detached[path] = node;
+	}
+	NSDictionary<NSString*, NSString*> *source = [NSDictionary dictionaryWithObjects:paths forKeys:destinations];
+	for (NSString *dest in [destinations sortedArrayUsingComparator:^NSComparisonResult(NSString *a, NSString *b) { return ComparePath(a, b); }]) {
+		[self attachNode:detached[source[dest]] atPath:dest];
 	}
 }
 
+/// Delete subtree at @c path. Following siblings are shifted up (same as @c sortIndex ).
+- (void)removeItemAtPath:(NSString*)path {
+	[self detachNodeAtPath:path];
+}
+
+/// Delete multiple subtrees at once. Paths are processed deepest and last first, so that no path is shifted before removal.
+- (void)removeItemsAtPaths:(NSArray<NSString*>*)paths {
+	for (NSString *path in [paths sortedArrayUsingComparator:^NSComparisonResult(NSString *a, NSString *b) { return ComparePath(b, a); }]) {
+		[self detachNodeAtPath:path];
+	}
+}
+
+#pragma mark - Helper
+
+/// Find node for dot separated @c path. If @c flag @c = @c YES non-existing items will be created.
+- (nullable UnreadTotal*)nodeForPath:(NSString*)path create:(BOOL)flag {
+	NSUInteger idx[MAX_PATH_DEPTH];
+	return [self nodeForIndices:idx depth:ParseIndexPath(path, idx) create:flag];
+}
+
+/// Walk down the tree from root node. @return @c nil if any node is missing and @c flag @c = @c NO.
+- (nullable UnreadTotal*)nodeForIndices:(NSUInteger*)indices depth:(NSUInteger)depth create:(BOOL)flag {
+	return [self nodeForIndices:indices depth:depth create:flag startingAt:_root];
+}
+
+/// Walk down the tree from @c node. @return @c nil if any node is missing and @c flag @c = @c NO.
+- (nullable UnreadTotal*)nodeForIndices:(NSUInteger*)indices depth:(NSUInteger)depth create:(BOOL)flag startingAt:(UnreadTotal*)node {
+	for (NSUInteger i = 0; i < depth; i++) {
+		NSUInteger k = indices[i];
+		NSPointerArray *list = node.children;
+		UnreadTotal *next = (k < list.count) ? (__bridge UnreadTotal*)[list pointerAtIndex:k] : nil;
+		if (!next) {
+			if (!flag) return nil;
+			next = [UnreadTotal new];
+			next.parent = node;
+			list = [node childrenCreate];
+			if (list.count <= k)
+				list.count = k + 1;
+			[list replacePointerAtIndex:k withPointer:(__bridge void*)next];
+		}
+		node = next;
+	}
+	return node;
+}
+
+/// Remove node from tree and subtract its counts from all parents. @return Detached node (or @c nil ).
+- (nullable UnreadTotal*)detachNodeAtPath:(NSString*)path {
+	NSUInteger idx[MAX_PATH_DEPTH];
+	NSUInteger depth = ParseIndexPath(path, idx);
+	if (depth == 0) return nil; // root can't be removed
+	UnreadTotal *parent = [self nodeForIndices:idx depth:depth - 1 create:NO];
+	NSUInteger k = idx[depth - 1];
+	if (!parent || k >= parent.children.count) return nil;
+	UnreadTotal *node = (__bridge UnreadTotal*)[parent.children pointerAtIndex:k];
+	[parent.children removePointerAtIndex:k];
+	if (node) {
+		[self addUnread:-(NSInteger)node.unread total:-(NSInteger)node.total toNode:parent];
+		node.parent = nil;
+	}
+	return node;
+}
+
+/// Insert detached @c node at @c path and add its counts to all parents. Following siblings are shifted down.
+- (void)attachNode:(nullable UnreadTotal*)node atPath:(NSString*)path {
+	NSUInteger idx[MAX_PATH_DEPTH];
+	NSUInteger depth = ParseIndexPath(path, idx);
+	if (!node || depth == 0) return;
+	UnreadTotal *parent = [self nodeForIndices:idx depth:depth - 1 create:YES];
+	NSPointerArray *siblings = [parent childrenCreate];
+	if (siblings.count < idx[depth - 1])
+		siblings.count = idx[depth - 1];
+	[siblings insertPointer:(__bridge void*)node atIndex:idx[depth - 1]];
+	node.parent = parent;
+	[self addUnread:(NSInteger)node.unread total:(NSInteger)node.total toNode:parent];
+}
+
+/// Apply signed delta to @c node and all its parents.
+- (void)addUnread:(NSInteger)unread total:(NSInteger)total toNode:(UnreadTotal*)node {
+	if (unread == 0 && total == 0)
+		return;
+	for (; node; node = node.parent) {
+		node.unread = (NSUInteger)MAX(0, (NSInteger)node.unread + unread);
+		node.total = (NSUInteger)MAX(0, (NSInteger)node.total + total);
+	}
+}
+
+
+#ifdef DEBUG
+#pragma mark - Benchmark (DEBUG)
+
+/**
+ Developer tool. Print duration of build, lookup, update, move and remove for 5k feeds nested 10 levels deep.
+ Total unread count must not change after moving. Started with @c barss:config/benchmark/unread
+ */
++ (void)benchmark {
+	NSUInteger const count = 5000, depth = 10;
+	NSMutableArray<NSDictionary*> *data = [NSMutableArray arrayWithCapacity:count];
+	NSMutableArray<NSString*> *paths = [NSMutableArray arrayWithCapacity:count];
+	for (NSUInteger i = 0; i < count; i++) {
+		NSMutableString *path = [NSMutableString string];
+		for (NSUInteger d = 0, x = i; d < depth; d++, x /= 3) // base-3 digits, unique for up to 3^10 feeds
+			[path appendFormat:(d == 0 ? @"%lu" : @".%lu"), x % 3];
+		[paths addObject:path];
+		[data addObject:@{ @"indexPath": path, @"unreadCount": @(i % 7), @"totalCount": @(i % 7 + 10) }];
+	}
+	__block MapUnreadTotal *map;
+	printf("--- unread map %lu feeds, depth %lu ---\n", count, depth);
+	benchmark("build", ^{ map = [[MapUnreadTotal alloc] initWithCoreData:data]; });
+	NSUInteger unread = map[@""].unread;
+	benchmark("itemsForPath (all)", ^{ for (NSString *p in paths) [map itemsForPath:p create:NO]; });
+	benchmark("addUnread (all)", ^{ for (NSString *p in paths) [map addUnread:1 total:0 forPath:p]; });
+	benchmark("addUnread (revert)", ^{ for (NSString *p in paths) [map addUnread:-1 total:0 forPath:p]; });
+	benchmark("move 100 subtrees", ^{
+		for (NSUInteger i = 0; i < 100; i++) // back and forth
+			[map moveItemAtPath:(i % 2 ? @"2.2.2.0" : @"0.0.0") toPath:(i % 2 ? @"0.0.0" : @"2.2.2.0")];
+	});
+	printf("unread: %lu -> %lu (%s)\n", unread, map[@""].unread, unread == map[@""].unread ? "stable" : "CHANGED");
+	benchmark("remove 100 feeds", ^{ [map removeItemsAtPaths:[paths subarrayWithRange:NSMakeRange(0, 100)]]; });
+}
+#endif
+
 @end
 
 
 @implementation UnreadTotal
 - (NSString *)description { return [NSString stringWithFormat:@"<unread: %lu, total: %lu>", _unread, _total]; }
+
+/// @return Children list. Create empty list if necessary.
+- (NSPointerArray*)childrenCreate {
+	if (!_children)
+		_children = [NSPointerArray strongObjectsPointerArray];
+	return _children;
+}
 @end
@@ -204,9 +204,14 @@ typedef NS_ENUM(NSInteger, MenuItemTag) {
 	} else { // main menu
 		path = nil;
 	}
-	NSManagedObjectContext *moc = [StoreCoordinator createChildContext];
-	NSArray<FeedArticle*> *list = [StoreCoordinator articlesAtPath:path isFeed:isFeedMenu sorted:openLinks unread:markRead inContext:moc limit:limit];
-	NSArray<NSString *> *notificationIds = [StoreCoordinator updateArticles:list markRead:markRead andOpen:openLinks inContext:moc];
+	NSArray<NSString *> *notificationIds;
+	if (openLinks) { // need article links, load objects
+		NSManagedObjectContext *moc = [StoreCoordinator createChildContext];
+		NSArray<FeedArticle*> *list = [StoreCoordinator articlesAtPath:path isFeed:isFeedMenu sorted:YES unread:YES inContext:moc limit:limit];
+		notificationIds = [StoreCoordinator updateArticles:list markRead:YES andOpen:YES inContext:moc];
+	} else {
+		notificationIds = [StoreCoordinator markAllArticlesAtPath:path isFeed:isFeedMenu markRead:markRead];
+	}
 	if (@available(macOS 10.14, *)) {
 		[NotifyEndpoint dismiss:notificationIds];
 	}